@@ -0,0 +1,79 @@
+/*!
+ * @file       keysetup.cpp
+ * @brief      测量秘钥编排的速度、每个秘钥占用的内存(与重写之前的bitset实现
+ *             ReferenceDES比较)，以及多秘钥批量加密与逐个加密的吞吐量
+ *
+ *             g++ keysetup.cpp -o keysetup -std=c++17 -O2 -pthread -I../src
+ */
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "DES.H"
+#include "../test/ReferenceDES.H"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static double seconds(Clock::time_point a, Clock::time_point b) {
+    return chrono::duration<double>(b - a).count();
+}
+
+int main(void) {
+    const size_t KEYS = 100000;
+    vector<uint64_t> rawKeys(KEYS);
+    uint64_t x = 0x0123456789ABCDEFULL;
+    for (size_t i = 0; i < KEYS; i++) {
+        // xorshift，生成不同的秘钥
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        rawKeys[i] = x;
+    }
+
+    printf("memory per live key: DESKeySchedule %zu bytes, DES %zu bytes, ReferenceDES %zu bytes\n",
+           sizeof(DESKeySchedule), sizeof(DES), sizeof(ReferenceDES));
+
+    // 秘钥编排
+    vector<DESKeySchedule> schedules(KEYS);
+    Clock::time_point t0 = Clock::now();
+    for (size_t i = 0; i < KEYS; i++) schedules[i] = DESKeySchedule(rawKeys[i]);
+    Clock::time_point t1 = Clock::now();
+    printf("key setup (DESKeySchedule):  %.0f keys/s\n", KEYS / seconds(t0, t1));
+
+    vector<DES> des;
+    des.reserve(KEYS);
+    t0 = Clock::now();
+    for (size_t i = 0; i < KEYS; i++) des.push_back(DES(bitset<64>(rawKeys[i])));
+    t1 = Clock::now();
+    printf("key setup (DES from bitset): %.0f keys/s\n", KEYS / seconds(t0, t1));
+
+    // 原来的实现每个秘钥占几KB，只取一部分秘钥
+    const size_t REF_KEYS = KEYS / 10;
+    vector<ReferenceDES> ref;
+    ref.reserve(REF_KEYS);
+    t0 = Clock::now();
+    for (size_t i = 0; i < REF_KEYS; i++) ref.emplace_back(bitset<64>(rawKeys[i]));
+    t1 = Clock::now();
+    printf("key setup (ReferenceDES):    %.0f keys/s\n", REF_KEYS / seconds(t0, t1));
+
+    // 每个秘钥加密一个分组
+    vector<const DESKeySchedule*> keys(KEYS);
+    for (size_t i = 0; i < KEYS; i++) keys[i] = &schedules[i];
+    vector<uint64_t> blocks(rawKeys), out(KEYS);
+    const int ROUNDS = 20;
+
+    t0 = Clock::now();
+    for (int r = 0; r < ROUNDS; r++)
+        for (size_t i = 0; i < KEYS; i++) out[i] = DESCore::encryptBlock(blocks[i], *keys[i]);
+    t1 = Clock::now();
+    printf("one block per key, one at a time: %.1f ns/block\n",
+           seconds(t0, t1) * 1e9 / (KEYS * ROUNDS));
+
+    t0 = Clock::now();
+    for (int r = 0; r < ROUNDS; r++)
+        DESCore::encryptBlocks(&keys[0], &blocks[0], &out[0], KEYS);
+    t1 = Clock::now();
+    printf("one block per key, interleaved:   %.1f ns/block\n",
+           seconds(t0, t1) * 1e9 / (KEYS * ROUNDS));
+    return 0;
+}
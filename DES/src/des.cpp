@@ -1,6 +1,7 @@
 #include <bitset>
 #include <iostream>
 #include "DES.H"
+#include "TripleDES.H"
 
 using namespace std;
 
@@ -12,12 +13,16 @@ int main(void) {
 	DES des(K);
 
 	// 加密文件
-	// void encryptFile(const char* plaintextFileName = "plaintext.txt", 
-    //                const char* cipherFileName = "cipher.txt")
-	des.encryptFile("flower.bmp", "flowerCipher.bmp");
+	// DESFileStats encryptFile(const char* plaintextFileName = "plaintext.txt", 
+    //                const char* cipherFileName = "cipher.txt", unsigned threads = 0)
+	DESFileStats stats = des.encryptFile("flower.bmp", "flowerCipher.bmp");
+	if (!stats.ok()) cout << "failed to encrypt flower.bmp (error " << stats.error << ")" << endl;
+	cout << "encrypt " << stats.bytesRead << " bytes with " << stats.threads << " threads: "
+	     << "read " << stats.readSeconds << "s, encrypt " << stats.cryptSeconds << "s, "
+	     << "write " << stats.writeSeconds << "s, total " << stats.totalSeconds << "s" << endl;
 	// 解密文件
-	// void decryptFile(const char* cipherFileName = "cipher.txt", 
-    //                const char* decryptionFileName = "decryptionResult.txt")
+	// DESFileStats decryptFile(const char* cipherFileName = "cipher.txt", 
+    //                const char* decryptionFileName = "decryptionResult.txt", unsigned threads = 0)
 	des.decryptFile("flowerCipher.bmp", "flowerDec.bmp");
 
 	bitset<64> t = 0x5555555555555555;
@@ -31,5 +36,10 @@ int main(void) {
 
 	cout << "// we can show the difference between the source and decryption" << endl;
 	cout << "difference ---> " << (t^d) << endl;
+
+	// 三重DES，接口与DES类相同(SP 800-67中的例子在test/tripledes.cpp中检查)
+	TripleDES tdes(K, bitset<64>(0x0f1e2d3c4b5a6978), bitset<64>(0x1122334455667788));
+	tdes.encryptFile("flower.bmp", "flowerCipher3.bmp");
+	tdes.decryptFile("flowerCipher3.bmp", "flowerDec3.bmp");
 	return 0;
 }
@@ -0,0 +1,116 @@
+/*!
+ * @file       equivalence.cpp
+ * @brief      检查DES类(基于DESCore)与原来逐位置换的bitset实现逐位一致
+ *             ReferenceDES(见ReferenceDES.H)是重写之前DES.H中的分组运算部分，原样保留作为参照：
+ *             1. FIPS 46的例子 K = 133457799BBCDFF1, M = 0123456789ABCDEF, C = 85E813540F0AB405
+ *             2. 随机秘钥和随机分组，encrypt64/decrypt64、encryptBlock/decryptBlock与参照实现比较
+ *             3. 位切片的encryptBlocks/decryptBlocks与逐个分组的encryptBlock/decryptBlock比较，
+ *                两种位序，长度跨过64/256/512个分组一批的边界
+ *             有不一致时输出并返回非0
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <bitset>
+#include <vector>
+#include "DES.H"
+#include "ReferenceDES.H"
+
+using namespace std;
+
+static int failures = 0;
+
+// 参数都是bitset位序的整数，输出时换成FIPS位序的十六进制
+static void check(const char* what, uint64_t key, uint64_t in, uint64_t got, uint64_t expect) {
+    if (got == expect) return;
+    if (++failures <= 10)
+        printf("MISMATCH %s: key %016llX in %016llX got %016llX expect %016llX\n", what,
+               (unsigned long long)DESCore::reverseBits(key), (unsigned long long)DESCore::reverseBits(in),
+               (unsigned long long)DESCore::reverseBits(got), (unsigned long long)DESCore::reverseBits(expect));
+}
+
+// 位切片的批量接口与逐个分组比较，长度跨过64/256/512个分组一批的边界，两种位序
+static void batch() {
+    const size_t SIZES[] = { 0, 1, 63, 64, 65, 255, 256, 257, 511, 512, 513, 1000 };
+    uint64_t x = 0xD1B54A32D192ED03ULL;
+    std::vector<uint64_t> in(1000), out(1000), back(1000);
+    for (int k = 0; k < 4; k++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        uint64_t key = x;
+        DES des((bitset<64>(key)));
+        const DESKeySchedule& ks = des.keySchedule();
+        for (size_t i = 0; i < in.size(); i++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            in[i] = x;
+        }
+
+        for (size_t n : SIZES) {
+            // LSB_FIRST，即DES类的encryptBlocks/decryptBlocks
+            des.encryptBlocks(&in[0], &out[0], n);
+            for (size_t i = 0; i < n; i++) check("encryptBlocks", key, in[i], out[i], des.encryptBlock(in[i]));
+            des.decryptBlocks(&in[0], &out[0], n);
+            for (size_t i = 0; i < n; i++) check("decryptBlocks", key, in[i], out[i], des.decryptBlock(in[i]));
+
+            // FIPS_ORDER，与DESCore一致
+            DESBitslice::encryptBlocks(&in[0], &out[0], n, ks, DESBitslice::FIPS_ORDER);
+            for (size_t i = 0; i < n; i++)
+                check("encryptBlocks FIPS_ORDER", key, in[i], out[i], DESCore::encryptBlock(in[i], ks));
+            DESBitslice::decryptBlocks(&in[0], &out[0], n, ks, DESBitslice::FIPS_ORDER);
+            for (size_t i = 0; i < n; i++)
+                check("decryptBlocks FIPS_ORDER", key, in[i], out[i], DESCore::decryptBlock(in[i], ks));
+
+            // 原地加密后再原地解密
+            back.assign(in.begin(), in.begin() + n);
+            back.resize(in.size());
+            des.encryptBlocks(&back[0], &back[0], n);
+            des.decryptBlocks(&back[0], &back[0], n);
+            for (size_t i = 0; i < n; i++) check("in-place round trip", key, in[i], back[i], in[i]);
+        }
+    }
+}
+
+int main(void) {
+    // FIPS 46的例子按FIPS位序(第1位为最高位)给出，bitset的下标i对应第i+1位
+    const uint64_t K = DESCore::reverseBits(0x133457799BBCDFF1ULL);
+    const uint64_t M = DESCore::reverseBits(0x0123456789ABCDEFULL);
+    const uint64_t C = DESCore::reverseBits(0x85E813540F0AB405ULL);
+    {
+        DES des((bitset<64>(K)));
+        ReferenceDES ref((bitset<64>(K)));
+        check("FIPS 46 reference encrypt", K, M, ref.encrypt64(bitset<64>(M)).to_ullong(), C);
+        check("FIPS 46 encrypt64", K, M, des.encrypt64(bitset<64>(M)).to_ullong(), C);
+        check("FIPS 46 decrypt64", K, C, des.decrypt64(bitset<64>(C)).to_ullong(), M);
+        check("FIPS 46 encryptBlock", K, M, des.encryptBlock(M), C);
+        check("FIPS 46 decryptBlock", K, C, des.decryptBlock(C), M);
+    }
+
+    // 随机秘钥、随机分组(xorshift，固定种子，结果可以重现)
+    const int KEYS = 1000, BLOCKS = 4;
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (int k = 0; k < KEYS; k++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        uint64_t key = x;
+        DES des((bitset<64>(key)));
+        ReferenceDES ref((bitset<64>(key)));
+        for (int b = 0; b < BLOCKS; b++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            uint64_t block = x;
+            uint64_t c = ref.encrypt64(bitset<64>(block)).to_ullong();
+            uint64_t p = ref.decrypt64(bitset<64>(block)).to_ullong();
+            check("encrypt64", key, block, des.encrypt64(bitset<64>(block)).to_ullong(), c);
+            check("decrypt64", key, block, des.decrypt64(bitset<64>(block)).to_ullong(), p);
+            check("encryptBlock", key, block, des.encryptBlock(block), c);
+            check("decryptBlock", key, block, des.decryptBlock(block), p);
+        }
+    }
+
+    batch();
+
+    if (failures) {
+        printf("%d mismatches\n", failures);
+        return 1;
+    }
+    printf("OK: FIPS 46 vector and %d random key/block pairs match the bitset implementation, "
+           "batch (%zu lanes) matches scalar\n", KEYS * BLOCKS, DESBitslice::lanes());
+    return 0;
+}
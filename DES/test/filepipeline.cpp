@@ -0,0 +1,149 @@
+/*!
+ * @file       filepipeline.cpp
+ * @brief      文件加密解密的检查，有不一致时输出并返回非0
+ *             1. DES::encryptFile的输出与逐个分组调用encryptBlock(末尾按缺少的字节数填充)的结果比较，
+ *                decryptFile再解密回来；长度覆盖空文件、不足一个分组、块边界前后和多块，
+ *                线程数为1、3、8
+ *             2. 输入文件不存在时error为OPEN_INPUT且不创建输出文件，
+ *                输出文件不能写时error为OPEN_OUTPUT(/dev/full存在时再检查WRITE)
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <bitset>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "DES.H"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static int failures = 0;
+
+static void fail(const string& what) {
+    if (++failures <= 10) printf("MISMATCH %s\n", what.c_str());
+}
+
+static uint64_t next(uint64_t& x) {
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    return x;
+}
+
+static bool writeFile(const string& name, const vector<uint8_t>& data) {
+    FILE* fp = fopen(name.c_str(), "wb");
+    if (!fp) return false;
+    bool ok = data.empty() || fwrite(data.data(), 1, data.size(), fp) == data.size();
+    return fclose(fp) == 0 && ok;
+}
+
+static bool readFile(const string& name, vector<uint8_t>& data) {
+    data.clear();
+    FILE* fp = fopen(name.c_str(), "rb");
+    if (!fp) return false;
+    uint8_t buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) data.insert(data.end(), buf, buf + n);
+    return fclose(fp) == 0;
+}
+
+// 逐个分组加密，第i个字节是分组的第8i..8i+7位
+static vector<uint8_t> expected(const DES& des, vector<uint8_t> data) {
+    if (data.size() % 8) {
+        size_t pad = 8 - data.size() % 8;
+        data.insert(data.end(), pad, (uint8_t)pad);
+    }
+    for (size_t i = 0; i < data.size(); i += 8) {
+        uint64_t x = 0;
+        for (int j = 0; j < 8; j++) x |= (uint64_t)data[i + j] << (8 * j);
+        x = des.encryptBlock(x);
+        for (int j = 0; j < 8; j++) data[i + j] = (uint8_t)(x >> (8 * j));
+    }
+    return data;
+}
+
+static void roundTrip(const fs::path& dir) {
+    const size_t CHUNK = DESFilePipeline::DEFAULT_CHUNK_BYTES;
+    const size_t SIZES[] = { 0, 1, 7, 8, 9, CHUNK - 1, CHUNK, CHUNK + 1, 3 * CHUNK + 5 };
+    const unsigned THREADS[] = { 1, 3, 8 };
+    DES des(bitset<64>(0x133457799BBCDFF1ULL));
+    string plain = (dir / "plain").string();
+    string cipher = (dir / "cipher").string();
+    string result = (dir / "result").string();
+
+    uint64_t x = 1;
+    for (size_t size : SIZES) {
+        vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; i++) data[i] = (uint8_t)next(x);
+        if (!writeFile(plain, data)) {
+            fail("cannot write " + plain);
+            return;
+        }
+        vector<uint8_t> expect = expected(des, data);
+        // 解密结果是补齐到8字节的明文
+        vector<uint8_t> padded = data;
+        if (size % 8) padded.insert(padded.end(), 8 - size % 8, (uint8_t)(8 - size % 8));
+
+        for (unsigned threads : THREADS) {
+            string what = "size " + to_string(size) + " threads " + to_string(threads);
+            vector<uint8_t> got;
+            DESFileStats s = des.encryptFile(plain.c_str(), cipher.c_str(), threads);
+            if (!s.ok() || !readFile(cipher, got) || got != expect) {
+                fail("encryptFile " + what);
+                continue;
+            }
+            if (s.bytesRead != size || s.bytesWritten != expect.size()) fail("encryptFile stats " + what);
+            s = des.decryptFile(cipher.c_str(), result.c_str(), threads);
+            if (!s.ok() || !readFile(result, got) || got != padded) fail("decryptFile " + what);
+        }
+    }
+}
+
+static void errors(const fs::path& dir) {
+    DES des(bitset<64>(0x133457799BBCDFF1ULL));
+    string plain = (dir / "plain").string();
+    if (!writeFile(plain, vector<uint8_t>(100, 1))) {
+        fail("cannot write " + plain);
+        return;
+    }
+
+    string missing = (dir / "missing").string();
+    string out = (dir / "out").string();
+    DESFileStats s = des.encryptFile(missing.c_str(), out.c_str(), 1);
+    if (s.error != DESFileStats::OPEN_INPUT) fail("missing input: error " + to_string(s.error));
+    if (fs::exists(out)) fail("missing input: output file was created");
+
+    // 目录和不存在的目录中的文件都不能作为输出打开
+    s = des.encryptFile(plain.c_str(), dir.string().c_str(), 1);
+    if (s.error != DESFileStats::OPEN_OUTPUT) fail("directory output: error " + to_string(s.error));
+    string noDir = (dir / "noDir" / "out").string();
+    s = des.encryptFile(plain.c_str(), noDir.c_str(), 1);
+    if (s.error != DESFileStats::OPEN_OUTPUT) fail("output in missing directory: error " + to_string(s.error));
+
+    // /dev/full能打开，写入时出错
+    std::error_code ec;
+    if (fs::exists("/dev/full", ec)) {
+        s = des.encryptFile(plain.c_str(), "/dev/full", 1);
+        if (s.error != DESFileStats::WRITE) fail("/dev/full: error " + to_string(s.error));
+    }
+}
+
+int main(void) {
+    std::error_code ec;
+    fs::path dir = fs::temp_directory_path(ec) / ("desFilePipeline." + to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    if (!fs::create_directories(dir, ec)) {
+        printf("cannot create %s\n", dir.string().c_str());
+        return 1;
+    }
+    roundTrip(dir);
+    errors(dir);
+    fs::remove_all(dir, ec);
+
+    if (failures) {
+        printf("%d mismatches\n", failures);
+        return 1;
+    }
+    printf("OK: encryptFile/decryptFile against encryptBlock with count padding, 1/3/8 threads; open and write errors\n");
+    return 0;
+}
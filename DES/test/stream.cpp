@@ -0,0 +1,286 @@
+/*!
+ * @file       stream.cpp
+ * @brief      DESStream和TripleDESStream的检查，有不一致时输出并返回非0
+ *             1. CBC模式的标准例子：FIPS 81中的单重DES例子，两秘钥、三秘钥的三重DES
+ *                (结果来自openssl enc -des-cbc / -des-ede-cbc / -des-ede3-cbc)
+ *             2. 把输入随机地分成若干段(包括0字节和1字节的段)调用update，
+ *                结果与一次update的结果相同；CBC加密解密、无填充的CBC以及CTR
+ *             3. 解密时长度不是8的倍数、填充为0、填充大于8、填充字节不一致，final都返回false
+ *             4. CTR模式seek到任意位置(包括不是8的倍数的位置)后解密一段，与从头解密的结果相同
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "TripleDES.H"
+
+using namespace std;
+
+static int failures = 0;
+
+static void fail(const string& what) {
+    if (++failures <= 10) printf("MISMATCH %s\n", what.c_str());
+}
+
+static uint64_t next(uint64_t& x) {
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    return x;
+}
+
+static vector<uint8_t> hex(const char* s) {
+    vector<uint8_t> re;
+    for (; s[0] && s[1]; s += 2) {
+        unsigned v;
+        sscanf(s, "%2x", &v);
+        re.push_back((uint8_t)v);
+    }
+    return re;
+}
+
+static vector<uint8_t> bytes(const char* s) {
+    return vector<uint8_t>(s, s + strlen(s));
+}
+
+static vector<uint8_t> randomBytes(size_t n, uint64_t& x) {
+    vector<uint8_t> re(n);
+    for (size_t i = 0; i < n; i++) re[i] = (uint8_t)next(x);
+    return re;
+}
+
+/**
+ * @brief      按splits中的长度依次update(最后一段为剩下的全部)，再final
+ *
+ * @return     final的返回值
+ */
+template <class Stream>
+static bool process(Stream& s, const vector<uint8_t>& in, const vector<size_t>& splits,
+                    vector<uint8_t>& out) {
+    out.assign(in.size() + 8, 0);
+    uint8_t* o = out.data();
+    size_t pos = 0;
+    for (size_t n : splits) {
+        if (n > in.size() - pos) n = in.size() - pos;
+        o += s.update(in.data() + pos, n, o);
+        pos += n;
+    }
+    o += s.update(in.data() + pos, in.size() - pos, o);
+    size_t last;
+    bool ok = s.final(o, last);
+    out.resize(o + last - out.data());
+    return ok;
+}
+
+template <class Stream>
+static bool oneShot(Stream& s, const vector<uint8_t>& in, vector<uint8_t>& out) {
+    return process(s, in, vector<size_t>(), out);
+}
+
+template <class Stream>
+static void knownAnswer(const char* what, const char* key, const vector<uint8_t>& plain,
+                        const char* cipher) {
+    vector<uint8_t> k = hex(key), iv = hex("1234567890ABCDEF"), expect = hex(cipher), got;
+    Stream s;
+    if (!s.init(k.data(), k.size(), Stream::CBC, Stream::ENCRYPT, iv.data()) ||
+        !oneShot(s, plain, got) || got != expect)
+        fail(string(what) + " encrypt");
+    if (!s.init(k.data(), k.size(), Stream::CBC, Stream::DECRYPT, iv.data()) ||
+        !oneShot(s, expect, got) || got != plain)
+        fail(string(what) + " decrypt");
+}
+
+static void knownAnswers() {
+    // FIPS 81附录中的CBC例子，openssl在后面多加一个填充分组
+    knownAnswer<DESStream>("DES-CBC", "0123456789ABCDEF", bytes("Now is the time for all "),
+        "E5C7CDDE872BF27C43E934008C389C0F683788499A7C05F662C16A27E4FCF277");
+    knownAnswer<TripleDESStream>("DES-EDE-CBC", "0123456789ABCDEF23456789ABCDEF01",
+        bytes("The quick brown fox jumps"),
+        "4B3EA8ED70C4DCE545834C063E90B68D66332E9A287DCF0829A4ACCBB6B04856");
+    knownAnswer<TripleDESStream>("DES-EDE3-CBC", "0123456789ABCDEF23456789ABCDEF01456789ABCDEF0123",
+        bytes("The quick brown fox jumps"),
+        "5BA523A59A5109710DA06400F058192A743DC4DF1C59265549D536885726E088");
+
+    // 无填充时与FIPS 81中的三个分组完全相同
+    vector<uint8_t> k = hex("0123456789ABCDEF"), iv = hex("1234567890ABCDEF"), got;
+    DESStream s;
+    s.init(k.data(), DESStream::CBC, DESStream::ENCRYPT, iv.data(), DESStream::NO_PADDING);
+    if (!oneShot(s, bytes("Now is the time for all "), got) ||
+        got != hex("E5C7CDDE872BF27C43E934008C389C0F683788499A7C05F6"))
+        fail("DES-CBC without padding");
+}
+
+// 随机的分段长度，一半左右是0或1字节，其余的有短有长(超过一次批量处理的512个分组)
+static vector<size_t> randomSplits(size_t len, uint64_t& x) {
+    vector<size_t> re;
+    size_t total = 0;
+    while (total < len) {
+        uint64_t r = next(x);
+        size_t n;
+        switch (r % 6) {
+        case 0: n = 0; break;
+        case 1: n = 1; break;
+        case 2: n = (size_t)(r >> 8) % 8; break;
+        case 3: case 4: n = (size_t)(r >> 8) % 100; break;
+        default: n = (size_t)(r >> 8) % 6000; break;
+        }
+        re.push_back(n);
+        total += n;
+    }
+    return re;
+}
+
+template <class Stream>
+static void splitsOne(const char* name, const vector<uint8_t>& key, typename Stream::Mode mode,
+                      typename Stream::Padding padding, uint64_t& x) {
+    const size_t LENGTHS[] = { 0, 1, 7, 8, 9, 63, 64, 65, 4095, 4096, 4097, 10000 };
+    vector<uint8_t> iv = randomBytes(8, x);
+    Stream s;
+    for (size_t len : LENGTHS) {
+        if (padding == Stream::NO_PADDING && mode == Stream::CBC && len % 8) continue;
+        string what = string(name) + " length " + to_string(len);
+        vector<uint8_t> plain = randomBytes(len, x), cipher, got;
+
+        s.init(key.data(), key.size(), mode, Stream::ENCRYPT, iv.data(), padding);
+        if (!oneShot(s, plain, cipher)) {
+            fail(what + " one-shot encrypt");
+            continue;
+        }
+        s.init(key.data(), key.size(), mode, Stream::DECRYPT, iv.data(), padding);
+        if (!oneShot(s, cipher, got) || got != plain) fail(what + " one-shot decrypt");
+
+        for (int t = 0; t < 20; t++) {
+            s.init(key.data(), key.size(), mode, Stream::ENCRYPT, iv.data(), padding);
+            if (!process(s, plain, randomSplits(len, x), got) || got != cipher)
+                fail(what + " split encrypt");
+            s.init(key.data(), key.size(), mode, Stream::DECRYPT, iv.data(), padding);
+            if (!process(s, cipher, randomSplits(cipher.size(), x), got) || got != plain)
+                fail(what + " split decrypt");
+        }
+    }
+}
+
+static void splits() {
+    uint64_t x = 1;
+    vector<uint8_t> k8 = randomBytes(8, x), k16 = randomBytes(16, x), k24 = randomBytes(24, x);
+    splitsOne<DESStream>("DES-CBC", k8, DESStream::CBC, DESStream::PKCS7, x);
+    splitsOne<DESStream>("DES-CBC no padding", k8, DESStream::CBC, DESStream::NO_PADDING, x);
+    splitsOne<DESStream>("DES-CTR", k8, DESStream::CTR, DESStream::PKCS7, x);
+    splitsOne<TripleDESStream>("DES-EDE-CBC", k16, TripleDESStream::CBC, TripleDESStream::PKCS7, x);
+    splitsOne<TripleDESStream>("DES-EDE3-CBC", k24, TripleDESStream::CBC, TripleDESStream::PKCS7, x);
+    splitsOne<TripleDESStream>("DES-EDE3-CTR", k24, TripleDESStream::CTR, TripleDESStream::PKCS7, x);
+}
+
+// 用无填充的CBC加密给定的明文(最后一个分组就是要检查的填充)，再按PKCS#7解密
+static bool decryptPadded(const vector<uint8_t>& key, const vector<uint8_t>& iv,
+                          const vector<uint8_t>& plain, vector<uint8_t>& got) {
+    vector<uint8_t> cipher;
+    DESStream s;
+    s.init(key.data(), DESStream::CBC, DESStream::ENCRYPT, iv.data(), DESStream::NO_PADDING);
+    oneShot(s, plain, cipher);
+    s.init(key.data(), DESStream::CBC, DESStream::DECRYPT, iv.data());
+    return oneShot(s, cipher, got);
+}
+
+static void badPadding() {
+    uint64_t x = 2;
+    vector<uint8_t> key = randomBytes(8, x), iv = randomBytes(8, x), got;
+    DESStream s;
+
+    // 合法的填充1..8
+    for (int pad = 1; pad <= 8; pad++) {
+        vector<uint8_t> plain = randomBytes(16, x);
+        for (int i = 16 - pad; i < 16; i++) plain[i] = (uint8_t)pad;
+        if (!decryptPadded(key, iv, plain, got) || got != vector<uint8_t>(plain.begin(), plain.end() - pad))
+            fail("valid padding " + to_string(pad));
+    }
+
+    // 填充为0、大于8，最后一个分组全是这个值，只能由范围检查拒绝
+    const uint8_t BAD[] = { 0, 9, 16, 0x80, 0xFF };
+    for (uint8_t pad : BAD) {
+        vector<uint8_t> plain = randomBytes(16, x);
+        for (int i = 8; i < 16; i++) plain[i] = pad;
+        if (decryptPadded(key, iv, plain, got)) fail("padding " + to_string(pad) + " accepted");
+    }
+
+    // 填充字节不一致：最后一个字节为pad，前面pad-1个字节中有一个不同
+    for (int pad = 2; pad <= 8; pad++) {
+        for (int i = 16 - pad; i < 15; i++) {
+            vector<uint8_t> plain = randomBytes(16, x);
+            for (int j = 16 - pad; j < 16; j++) plain[j] = (uint8_t)pad;
+            plain[i] ^= 0x10;
+            if (decryptPadded(key, iv, plain, got))
+                fail("padding " + to_string(pad) + " with byte " + to_string(i) + " changed accepted");
+        }
+    }
+
+    // 密文长度不是8的倍数(包括空的密文)
+    vector<uint8_t> cipher;
+    s.init(key.data(), DESStream::CBC, DESStream::ENCRYPT, iv.data());
+    oneShot(s, randomBytes(20, x), cipher);
+    for (size_t len = 0; len <= cipher.size(); len++) {
+        if (len % 8 == 0 && len > 0) continue;
+        s.init(key.data(), DESStream::CBC, DESStream::DECRYPT, iv.data());
+        vector<uint8_t> truncated(cipher.begin(), cipher.begin() + len);
+        if (oneShot(s, truncated, got)) fail("truncated length " + to_string(len) + " accepted");
+    }
+    s.init(key.data(), DESStream::CBC, DESStream::DECRYPT, iv.data(), DESStream::NO_PADDING);
+    if (oneShot(s, vector<uint8_t>(cipher.begin(), cipher.begin() + 13), got))
+        fail("truncated length 13 accepted without padding");
+}
+
+template <class Stream>
+static void ctrSeekOne(const char* name, const vector<uint8_t>& key, uint64_t& x) {
+    const size_t OFFSETS[] = { 0, 1, 3, 7, 8, 9, 15, 17, 1001, 4095, 4096, 4100, 9999 };
+    const size_t LENGTHS[] = { 0, 1, 5, 8, 13, 100, 4099 };
+    vector<uint8_t> iv = randomBytes(8, x), plain = randomBytes(10000, x), cipher, got;
+    // 计数器初值接近2^64时也要正确进位
+    for (int i = 1; i < 8; i++) iv[i] = 0xFF;
+
+    Stream s;
+    s.init(key.data(), key.size(), Stream::CTR, Stream::ENCRYPT, iv.data());
+    oneShot(s, plain, cipher);
+
+    for (size_t offset : OFFSETS) {
+        for (size_t len : LENGTHS) {
+            if (offset + len > plain.size()) len = plain.size() - offset;
+            s.init(key.data(), key.size(), Stream::CTR, Stream::DECRYPT, iv.data());
+            if (!s.seek(offset)) {
+                fail(string(name) + " seek failed");
+                return;
+            }
+            // 分两段解密，第二段接在seek留下的密钥流之后
+            vector<uint8_t> range(cipher.begin() + offset, cipher.begin() + offset + len);
+            got.assign(len, 0);
+            size_t half = len / 2;
+            s.update(range.data(), half, got.data());
+            s.update(range.data() + half, len - half, got.data() + half);
+            if (got != vector<uint8_t>(plain.begin() + offset, plain.begin() + offset + len))
+                fail(string(name) + " seek " + to_string(offset) + " length " + to_string(len));
+        }
+    }
+
+    // CBC模式不能seek
+    s.init(key.data(), key.size(), Stream::CBC, Stream::DECRYPT, iv.data());
+    if (s.seek(8)) fail(string(name) + " seek accepted in CBC mode");
+}
+
+static void ctrSeek() {
+    uint64_t x = 3;
+    ctrSeekOne<DESStream>("DES-CTR", randomBytes(8, x), x);
+    ctrSeekOne<TripleDESStream>("DES-EDE3-CTR", randomBytes(24, x), x);
+}
+
+int main(void) {
+    knownAnswers();
+    splits();
+    badPadding();
+    ctrSeek();
+
+    if (failures) {
+        printf("%d mismatches\n", failures);
+        return 1;
+    }
+    printf("OK: CBC vectors (DES, EDE2, EDE3), split updates, padding checks, CTR seek\n");
+    return 0;
+}
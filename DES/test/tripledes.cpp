@@ -0,0 +1,126 @@
+/*!
+ * @file       tripledes.cpp
+ * @brief      三重DES的检查，有不一致时输出并返回非0
+ *             1. NIST SP 800-67中的例子(三个分组)，加密和解密
+ *             2. TripleDES::encryptBlock/decryptBlock与用DES类依次做E、D、E(解密时D、E、D)的结果比较，
+ *                两秘钥(EDE2)和三秘钥(EDE3)
+ *             3. 位切片的encryptBlocksEDE/decryptBlocksEDE与逐个分组的DESCore实现比较，两种位序
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <bitset>
+#include <vector>
+#include "TripleDES.H"
+
+using namespace std;
+
+static int failures = 0;
+
+static void check(const char* what, uint64_t in, uint64_t got, uint64_t expect) {
+    if (got == expect) return;
+    if (++failures <= 10)
+        printf("MISMATCH %s: in %016llX got %016llX expect %016llX\n", what,
+               (unsigned long long)in, (unsigned long long)got, (unsigned long long)expect);
+}
+
+static uint64_t next(uint64_t& x) {
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    return x;
+}
+
+// SP 800-67的例子，按FIPS位序
+static void knownAnswer() {
+    const uint64_t K1 = 0x0123456789ABCDEFULL, K2 = 0x23456789ABCDEF01ULL, K3 = 0x456789ABCDEF0123ULL;
+    // "The qufck brown fox jump"
+    const uint64_t P[3] = { 0x5468652071756663ULL, 0x6B2062726F776E20ULL, 0x666F78206A756D70ULL };
+    const uint64_t C[3] = { 0xA826FD8CE53B855FULL, 0xCCE21C8112256FE6ULL, 0x68D5C05DD9B6B900ULL };
+
+    DESKeySchedule k1(K1), k2(K2), k3(K3);
+    TripleDES tdes(k1, k2, k3);
+    TripleDES fromBitset(bitset<64>(DESCore::reverseBits(K1)), bitset<64>(DESCore::reverseBits(K2)),
+                         bitset<64>(DESCore::reverseBits(K3)));
+    for (int i = 0; i < 3; i++) {
+        check("SP 800-67 encryptBlockEDE", P[i], DESCore::encryptBlockEDE(P[i], k1, k2, k3), C[i]);
+        check("SP 800-67 decryptBlockEDE", C[i], DESCore::decryptBlockEDE(C[i], k1, k2, k3), P[i]);
+        // TripleDES类的分组按bitset位序
+        uint64_t p = DESCore::reverseBits(P[i]), c = DESCore::reverseBits(C[i]);
+        check("SP 800-67 TripleDES::encryptBlock", P[i], DESCore::reverseBits(tdes.encryptBlock(p)), C[i]);
+        check("SP 800-67 TripleDES::decryptBlock", C[i], DESCore::reverseBits(tdes.decryptBlock(c)), P[i]);
+        check("SP 800-67 TripleDES(bitset)", P[i], DESCore::reverseBits(fromBitset.encryptBlock(p)), C[i]);
+    }
+
+    uint64_t batch[3];
+    DESBitslice::encryptBlocksEDE(P, batch, 3, k1, k2, k3);
+    for (int i = 0; i < 3; i++) check("SP 800-67 encryptBlocksEDE", P[i], batch[i], C[i]);
+}
+
+// 与DES类组合出来的E-D-E比较
+static void composed() {
+    uint64_t x = 0x2545F4914F6CDD1DULL;
+    for (int k = 0; k < 200; k++) {
+        bitset<64> K1(next(x)), K2(next(x)), K3(next(x));
+        DES d1(K1), d2(K2), d3(K3);
+        TripleDES ede2(K1, K2), ede3(K1, K2, K3);
+        for (int b = 0; b < 8; b++) {
+            uint64_t block = next(x);
+            check("EDE2 encryptBlock", block, ede2.encryptBlock(block),
+                  d1.encryptBlock(d2.decryptBlock(d1.encryptBlock(block))));
+            check("EDE2 decryptBlock", block, ede2.decryptBlock(block),
+                  d1.decryptBlock(d2.encryptBlock(d1.decryptBlock(block))));
+            check("EDE3 encryptBlock", block, ede3.encryptBlock(block),
+                  d3.encryptBlock(d2.decryptBlock(d1.encryptBlock(block))));
+            check("EDE3 decryptBlock", block, ede3.decryptBlock(block),
+                  d1.decryptBlock(d2.encryptBlock(d3.decryptBlock(block))));
+            check("EDE3 encrypt64", block, ede3.encrypt64(bitset<64>(block)).to_ullong(),
+                  d3.encryptBlock(d2.decryptBlock(d1.encryptBlock(block))));
+        }
+    }
+}
+
+// 位切片与逐个分组比较，长度跨过64/256/512个分组一批的边界
+static void bitslice() {
+    const size_t SIZES[] = { 0, 1, 63, 64, 65, 255, 256, 257, 511, 512, 513, 1000, 1600 };
+    uint64_t x = 0x853C49E6748FEA9BULL;
+    DESKeySchedule k1(next(x)), k2(next(x)), k3(next(x));
+    std::vector<uint64_t> in(1600), out(1600);
+    for (size_t i = 0; i < in.size(); i++) in[i] = next(x);
+
+    for (size_t n : SIZES) {
+        for (int o = 0; o < 2; o++) {
+            DESBitslice::BitOrder order = o ? DESBitslice::LSB_FIRST : DESBitslice::FIPS_ORDER;
+            DESBitslice::encryptBlocksEDE(&in[0], &out[0], n, k1, k2, k3, order);
+            for (size_t i = 0; i < n; i++) {
+                uint64_t b = o ? DESCore::reverseBits(in[i]) : in[i];
+                uint64_t c = DESCore::encryptBlockEDE(b, k1, k2, k3);
+                check("encryptBlocksEDE", in[i], out[i], o ? DESCore::reverseBits(c) : c);
+            }
+            DESBitslice::decryptBlocksEDE(&in[0], &out[0], n, k1, k2, k3, order);
+            for (size_t i = 0; i < n; i++) {
+                uint64_t b = o ? DESCore::reverseBits(in[i]) : in[i];
+                uint64_t p = DESCore::decryptBlockEDE(b, k1, k2, k3);
+                check("decryptBlocksEDE", in[i], out[i], o ? DESCore::reverseBits(p) : p);
+            }
+        }
+    }
+
+    // 原地加密后再解密
+    std::vector<uint64_t> copy(in);
+    DESBitslice::encryptBlocksEDE(&copy[0], &copy[0], copy.size(), k1, k2, k3);
+    DESBitslice::decryptBlocksEDE(&copy[0], &copy[0], copy.size(), k1, k2, k3);
+    for (size_t i = 0; i < copy.size(); i++) check("in-place round trip", in[i], copy[i], in[i]);
+}
+
+int main(void) {
+    knownAnswer();
+    composed();
+    bitslice();
+
+    if (failures) {
+        printf("%d mismatches\n", failures);
+        return 1;
+    }
+    printf("OK: SP 800-67 vectors, EDE2/EDE3 against composed DES, bitsliced EDE (%zu lanes) against scalar\n",
+           DESBitslice::lanes());
+    return 0;
+}
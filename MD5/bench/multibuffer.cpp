@@ -0,0 +1,51 @@
+// Throughput of MD5Multi (multi-buffer SIMD) against hashing the same
+// messages one at a time with MD5Context, for message sizes 64 B .. 1 MB.
+//
+// g++ multibuffer.cpp -o multibuffer -std=c++11 -O2 -I../src
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "MD5Multi.hpp"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static double seconds(Clock::time_point a, Clock::time_point b) {
+    return chrono::duration<double>(b - a).count();
+}
+
+int main(void) {
+    // 每种长度都处理约64MB的数据
+    const size_t TOTAL = 64 << 20;
+    vector<uint8_t> data(TOTAL);
+    uint32_t x = 12345;
+    for (size_t i = 0; i < TOTAL; i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        data[i] = (uint8_t)x;
+    }
+
+    printf("lanes: %zu\n", MD5Multi::lanes());
+    printf("%10s %10s %14s %14s %8s\n", "size", "messages", "scalar MB/s", "multi MB/s", "speedup");
+    for (size_t size = 64; size <= (1 << 20); size *= 4) {
+        size_t n = TOTAL / size;
+        vector<MD5Span> spans(n);
+        for (size_t i = 0; i < n; i++) {
+            spans[i].data = &data[i * size];
+            spans[i].len = size;
+        }
+        vector<uint8_t> scalar(n * 16), multi(n * 16);
+
+        Clock::time_point t0 = Clock::now();
+        for (size_t i = 0; i < n; i++) MD5Context::hash(spans[i].data, size, &scalar[i * 16]);
+        Clock::time_point t1 = Clock::now();
+        MD5Multi::hash(&spans[0], n, (uint8_t (*)[16])&multi[0]);
+        Clock::time_point t2 = Clock::now();
+
+        double s = TOTAL / 1e6 / seconds(t0, t1), m = TOTAL / 1e6 / seconds(t1, t2);
+        printf("%10zu %10zu %14.0f %14.0f %7.2fx%s\n", size, n, s, m, m / s,
+               scalar == multi ? "" : "  MISMATCH");
+    }
+    return 0;
+}
@@ -1,13 +1,385 @@
+// 与md5sum兼容的命令行工具
+//
+//   MD5 [-j N] [FILE|DIR]...       输出每个文件的摘要，目录会递归展开
+//   MD5 -c [--quiet|--status] [-j N] [CHECKSUM_FILE]...
+//                                  检查md5sum格式的校验文件中列出的文件
+//
+// 没有给出文件或文件为"-"时读标准输入。
+// 文件在工作窃取线程池中并行计算：小文件成批读入后用MD5Multi同时计算，
+// 大文件用mmap映射后计算。结果按参数(目录内按文件名)的顺序输出，
+// 最后在标准错误上输出总的字节数和吞吐量。
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
 #include "MD5.hpp"
+#include "MD5File.hpp"
+#include "MD5Multi.hpp"
+#include "WorkStealingPool.hpp"
+
 using namespace std;
+namespace fs = std::filesystem;
+
+static const char* PROGRAM = "MD5";
+
+// 小于这个长度的文件整个读入内存，成批交给MD5Multi
+static const uint64_t SMALL_FILE = 256 << 10;
+// 一批小文件的个数和总长度的上限
+static const size_t BATCH_FILES = 64;
+static const uint64_t BATCH_BYTES = 8 << 20;
+
+struct Entry {
+    string path;
+    uint64_t size;          // 遍历时得到的长度，只用来分批
+    bool small;
+    uint8_t expect[16];     // -c: 校验文件中的摘要
+
+    // 以下由计算线程填写，done之后才能读
+    bool ok;
+    int err;
+    uint8_t digest[16];
+    uint64_t bytes;
+    bool done;
+
+    Entry(const string& path_, uint64_t size_, bool small_)
+        : path(path_), size(size_), small(small_), ok(false), err(0), bytes(0), done(false) {}
+};
+
+struct Run {
+    vector<Entry> entries;
+    mutex m;
+    condition_variable finished;
+    int status;
+
+    Run() : status(0) {}
+
+    void complete(size_t begin, size_t end) {
+        {
+            lock_guard<mutex> lock(m);
+            for (size_t i = begin; i < end; i++) entries[i].done = true;
+        }
+        finished.notify_all();
+    }
+
+    void waitFor(size_t i) {
+        unique_lock<mutex> lock(m);
+        finished.wait(lock, [this, i] { return entries[i].done; });
+    }
+};
+
+/************************ Collecting files ************************/
+
+static void error(const string& path, int err) {
+    fprintf(stderr, "%s: %s: %s\n", PROGRAM, path.c_str(), strerror(err));
+}
+
+static void addFile(Run& run, const string& path, bool regular, uint64_t size) {
+    run.entries.push_back(Entry(path, size, regular && size < SMALL_FILE));
+}
+
+// 递归展开目录，目录内按文件名排序，不跟随指向目录的符号链接
+static void walk(Run& run, const fs::path& dir) {
+    error_code ec;
+    vector<fs::directory_entry> children;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec))
+        children.push_back(*it);
+    if (ec) {
+        error(dir.string(), ec.value());
+        run.status = 1;
+        return;
+    }
+    sort(children.begin(), children.end(),
+         [](const fs::directory_entry& a, const fs::directory_entry& b) { return a.path() < b.path(); });
+
+    for (size_t i = 0; i < children.size(); i++) {
+        const fs::directory_entry& e = children[i];
+        fs::file_status link = e.symlink_status(ec);
+        if (!ec && fs::is_directory(link)) {
+            walk(run, e.path());
+            continue;
+        }
+        fs::file_status st = e.status(ec);
+        if (ec || !fs::is_regular_file(st)) continue;
+        addFile(run, e.path().string(), true, e.file_size(ec));
+    }
+}
+
+// 命令行上的一个参数，recurse为false时(-c模式)目录也当作文件
+static void collect(Run& run, const string& path, bool recurse) {
+    if (path == "-") {
+        addFile(run, path, false, 0);
+        return;
+    }
+    error_code ec;
+    fs::file_status st = fs::status(path, ec);
+    if (recurse && !ec && fs::is_directory(st)) {
+        walk(run, path);
+        return;
+    }
+    bool regular = !ec && fs::is_regular_file(st);
+    addFile(run, path, regular, regular ? fs::file_size(path, ec) : 0);
+}
+
+/************************ Hashing ************************/
+
+// 一批小文件：逐个读入，再一起计算
+static void hashBatch(Run& run, size_t begin, size_t end) {
+    thread_local vector<vector<uint8_t> > data;
+    if (data.size() < end - begin) data.resize(end - begin);
+
+    vector<MD5Span> spans;
+    vector<size_t> which;
+    for (size_t i = begin; i < end; i++) {
+        Entry& e = run.entries[i];
+        vector<uint8_t>& buf = data[i - begin];
+        if (!MD5File::read(e.path.c_str(), buf)) {
+            e.err = errno;
+            continue;
+        }
+        MD5Span span = { buf.empty() ? (const void*)"" : (const void*)&buf[0], buf.size() };
+        spans.push_back(span);
+        which.push_back(i);
+        e.ok = true;
+        e.bytes = buf.size();
+    }
+
+    vector<uint8_t> digests(spans.size() * 16);
+    if (!spans.empty()) MD5Multi::hash(&spans[0], spans.size(), (uint8_t (*)[16])&digests[0]);
+    for (size_t j = 0; j < which.size(); j++) memcpy(run.entries[which[j]].digest, &digests[16 * j], 16);
+    run.complete(begin, end);
+}
+
+static void hashLarge(Run& run, size_t i) {
+    Entry& e = run.entries[i];
+    e.ok = MD5File::hash(e.path.c_str(), e.digest, e.bytes);
+    if (!e.ok) e.err = errno;
+    run.complete(i, i + 1);
+}
+
+// 按顺序把相邻的小文件分批，大文件单独成为一个任务
+static void submitAll(Run& run, WorkStealingPool& pool) {
+    size_t n = run.entries.size();
+    for (size_t i = 0; i < n; ) {
+        if (!run.entries[i].small) {
+            pool.submit([&run, i] { hashLarge(run, i); });
+            i++;
+            continue;
+        }
+        size_t j = i;
+        uint64_t bytes = 0;
+        while (j < n && run.entries[j].small && j - i < BATCH_FILES && bytes < BATCH_BYTES)
+            bytes += run.entries[j++].size;
+        pool.submit([&run, i, j] { hashBatch(run, i, j); });
+        i = j;
+    }
+}
+
+/************************ md5sum format ************************/
+
+// 文件名中有'\\'或换行时，md5sum在行首加'\\'并转义文件名
+static bool needEscape(const string& name) {
+    return name.find_first_of("\\\n") != string::npos;
+}
+
+static string escape(const string& name) {
+    string re;
+    for (size_t i = 0; i < name.size(); i++) {
+        if (name[i] == '\\') re += "\\\\";
+        else if (name[i] == '\n') re += "\\n";
+        else re += name[i];
+    }
+    return re;
+}
+
+static bool unescape(const string& name, string& re) {
+    re.clear();
+    for (size_t i = 0; i < name.size(); i++) {
+        if (name[i] != '\\') {
+            re += name[i];
+            continue;
+        }
+        if (++i == name.size()) return false;
+        if (name[i] == '\\') re += '\\';
+        else if (name[i] == 'n') re += '\n';
+        else return false;
+    }
+    return true;
+}
+
+static void printDigest(const Entry& e) {
+    char hex[33];
+    for (int i = 0; i < 16; i++) sprintf(hex + 2 * i, "%02x", e.digest[i]);
+    if (needEscape(e.path)) printf("\\%s  %s\n", hex, escape(e.path).c_str());
+    else printf("%s  %s\n", hex, e.path.c_str());
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// 解析一行 "<32位十六进制>  <文件名>"，文件名前也可以是" *"(二进制模式)
+static bool parseLine(string line, string& path, uint8_t digest[16]) {
+    if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+    bool escaped = !line.empty() && line[0] == '\\';
+    if (escaped) line.erase(0, 1);
+    if (line.size() < 35 || line[32] != ' ' || (line[33] != ' ' && line[33] != '*')) return false;
+    for (int i = 0; i < 16; i++) {
+        int hi = hexValue(line[2 * i]), lo = hexValue(line[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        digest[i] = (uint8_t)(hi * 16 + lo);
+    }
+    path = line.substr(34);
+    if (escaped) return unescape(line.substr(34), path);
+    return true;
+}
+
+// 读入校验文件，返回格式不正确的行数
+static size_t readChecksums(Run& run, const string& fileName) {
+    FILE* fp = fileName == "-" ? stdin : fopen(fileName.c_str(), "r");
+    if (!fp) {
+        error(fileName, errno);
+        run.status = 1;
+        return 0;
+    }
+    size_t bad = 0, valid = 0;
+    string line;
+    int c;
+    for (bool more = true; more; ) {
+        line.clear();
+        while ((c = fgetc(fp)) != EOF && c != '\n') line += (char)c;
+        more = c != EOF;
+        if (!more && line.empty()) break;
+
+        string path;
+        uint8_t digest[16];
+        if (!parseLine(line, path, digest)) {
+            bad++;
+            continue;
+        }
+        collect(run, path, false);
+        Entry& e = run.entries.back();
+        memcpy(e.expect, digest, 16);
+        valid++;
+    }
+    if (fp != stdin) fclose(fp);
+    if (valid == 0) {
+        fprintf(stderr, "%s: %s: no properly formatted MD5 checksum lines found\n",
+                PROGRAM, fileName.c_str());
+        run.status = 1;
+    }
+    return bad;
+}
+
+static const char* plural(size_t n, const char* one, const char* many) {
+    return n == 1 ? one : many;
+}
+
+/************************ main ************************/
+
+static void usage() {
+    printf("Usage: %s [OPTION]... [FILE|DIR]...\n", PROGRAM);
+    printf("Print or check MD5 checksums; directories are hashed recursively.\n");
+    printf("With no FILE, or when FILE is -, read standard input.\n\n");
+    printf("  -c, --check      read MD5 sums from the FILEs and check them\n");
+    printf("  -j, --threads N  number of hashing threads (default: number of CPUs)\n");
+    printf("      --quiet      (with -c) don't print OK for each verified file\n");
+    printf("      --status     (with -c) don't output anything, status code shows success\n");
+    printf("  -h, --help       display this help and exit\n");
+}
 
 int main(int argc, char* argv[]) {
-    char* fileName = new char[1024];
-    if (argc < 2) {
-        printf("Please input source file name.\n");
-        exit(1);
-    }
-    MD5 md5;
-    md5.encrypt(argv[1]);
-    return 0;
+    bool check = false, quiet = false, statusOnly = false;
+    unsigned threads = 0;
+    vector<string> args;
+    bool options = true;
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        if (options && a == "--") options = false;
+        else if (options && (a == "-c" || a == "--check")) check = true;
+        else if (options && a == "--quiet") quiet = true;
+        else if (options && a == "--status") statusOnly = true;
+        else if (options && (a == "-h" || a == "--help")) { usage(); return 0; }
+        else if (options && (a == "-j" || a == "--threads")) {
+            if (++i == argc) { usage(); return 1; }
+            threads = (unsigned)atoi(argv[i]);
+        }
+        else if (options && a.size() > 2 && a.compare(0, 2, "-j") == 0) threads = (unsigned)atoi(a.c_str() + 2);
+        else if (options && a.size() > 1 && a[0] == '-') {
+            fprintf(stderr, "%s: invalid option '%s'\n", PROGRAM, a.c_str());
+            usage();
+            return 1;
+        }
+        else args.push_back(a);
+    }
+    if (args.empty()) args.push_back("-");
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Run run;
+    size_t badLines = 0;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (check) {
+            badLines += readChecksums(run, args[i]);
+        } else {
+            collect(run, args[i], true);
+        }
+    }
+
+    size_t failedRead = 0, mismatched = 0;
+    uint64_t bytes = 0;
+    {
+        WorkStealingPool pool(threads);
+        submitAll(run, pool);
+
+        // 按顺序输出，前面的文件完成就可以输出，不必等全部完成
+        for (size_t i = 0; i < run.entries.size(); i++) {
+            run.waitFor(i);
+            const Entry& e = run.entries[i];
+            bytes += e.bytes;
+            string shown = needEscape(e.path) ? "\\" + escape(e.path) : e.path;
+            if (!e.ok) {
+                if (!statusOnly) error(e.path, e.err);
+                if (check && !statusOnly) printf("%s: FAILED open or read\n", shown.c_str());
+                failedRead++;
+                run.status = 1;
+            } else if (!check) {
+                printDigest(e);
+            } else if (memcmp(e.digest, e.expect, 16) != 0) {
+                if (!statusOnly) printf("%s: FAILED\n", shown.c_str());
+                mismatched++;
+                run.status = 1;
+            } else if (!quiet && !statusOnly) {
+                printf("%s: OK\n", shown.c_str());
+            }
+        }
+    }
+    fflush(stdout);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (check && !statusOnly) {
+        if (badLines > 0)
+            fprintf(stderr, "%s: WARNING: %zu %s improperly formatted\n", PROGRAM, badLines,
+                    plural(badLines, "line is", "lines are"));
+        if (failedRead > 0)
+            fprintf(stderr, "%s: WARNING: %zu listed %s could not be read\n", PROGRAM, failedRead,
+                    plural(failedRead, "file", "files"));
+        if (mismatched > 0)
+            fprintf(stderr, "%s: WARNING: %zu computed %s did NOT match\n", PROGRAM, mismatched,
+                    plural(mismatched, "checksum", "checksums"));
+    }
+    if (!statusOnly) {
+        fprintf(stderr, "%s: %zu files, %.1f MB in %.3f s, %.1f MB/s\n", PROGRAM,
+                run.entries.size(), bytes / 1e6, seconds, seconds > 0 ? bytes / 1e6 / seconds : 0.0);
+    }
+    return run.status;
 }
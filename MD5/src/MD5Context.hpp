@@ -0,0 +1,238 @@
+#ifndef _MD5_CONTEXT_HPP_
+#define _MD5_CONTEXT_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// 多路并行的版本(MD5Multi.hpp)用向量类型实例化同一份轮函数，
+// 它们必须内联进带有target属性的函数中
+#if defined(__GNUC__)
+#define MD5_INLINE inline __attribute__((always_inline))
+#else
+#define MD5_INLINE inline
+#endif
+
+// Incremental MD5 (RFC 1321).
+// 用法: init -> 任意次 update -> final
+// update直接从调用者的缓冲区中按64字节一块进行压缩，
+// 只有不足一块的尾部才会复制到内部的缓冲区里，整个过程不分配内存。
+class MD5Context {
+public:
+    MD5Context() { init(); }
+
+    void init() {
+        state[0] = 0x67452301;
+        state[1] = 0xEFCDAB89;
+        state[2] = 0x98BADCFE;
+        state[3] = 0x10325476;
+        length = 0;
+        bufLen = 0;
+    }
+
+    // len为0时data可以为NULL
+    void update(const void* data, size_t len) {
+        if (len == 0) return;
+        const uint8_t* p = (const uint8_t*)data;
+        length += len;
+
+        // 先补满上一次剩下的半块
+        if (bufLen > 0) {
+            size_t take = 64 - bufLen < len ? 64 - bufLen : len;
+            memcpy(buf + bufLen, p, take);
+            bufLen += take;
+            p += take;
+            len -= take;
+            if (bufLen < 64) return;
+            compress(state, buf, 1);
+            bufLen = 0;
+        }
+
+        // 整块直接从调用者的数据中处理
+        size_t blocks = len / 64;
+        compress(state, p, blocks);
+        p += blocks * 64;
+        len -= blocks * 64;
+
+        memcpy(buf, p, len);
+        bufLen = len;
+    }
+
+    // 填充并输出16字节的摘要，之后需要重新init才能计算下一个
+    void final(uint8_t digest[16]) {
+        // 消息的位数，按2^64取模
+        uint64_t bits = length * 8;
+
+        // 10000000 00000000 ... 直到长度模64为56
+        uint8_t pad[72];
+        memset(pad, 0, sizeof(pad));
+        pad[0] = 0x80;
+        size_t padLen = bufLen < 56 ? 56 - bufLen : 120 - bufLen;
+        for (int i = 0; i < 8; i++) pad[padLen + i] = (uint8_t)(bits >> (8*i));
+        update(pad, padLen + 8);
+
+        for (int i = 0; i < 4; i++) store(state[i], digest + 4*i);
+    }
+
+    // 一次计算一段数据的摘要
+    static void hash(const void* data, size_t len, uint8_t digest[16]) {
+        MD5Context ctx;
+        ctx.update(data, len);
+        ctx.final(digest);
+    }
+
+    // 计算文件的摘要，文件打不开或读出错时返回false
+    // 与MD5File::hash相同(定义在MD5File.hpp中)
+    static bool hashFile(const char* fileName, uint8_t digest[16]);
+
+    // 依次压缩从p开始的n个64字节的块
+    static void compress(uint32_t st[4], const uint8_t* p, size_t n) {
+        for (; n > 0; n--, p += 64) {
+            uint32_t X[16];
+            for (int i = 0; i < 16; i++) X[i] = load(p + 4*i);
+            rounds(st, X);
+        }
+    }
+
+    // 一个块的64步，完全展开，轮函数、循环移位位数和消息下标都是常量
+    // W是uint32_t，或者每个元素是一条独立消息的32位向量
+    template <class W>
+    static MD5_INLINE void rounds(W st[4], const W X[16]) {
+        W a = st[0], b = st[1], c = st[2], d = st[3];
+
+        // Round 1
+        FF(a, b, c, d, X[ 0],  7, 0xd76aa478);
+        FF(d, a, b, c, X[ 1], 12, 0xe8c7b756);
+        FF(c, d, a, b, X[ 2], 17, 0x242070db);
+        FF(b, c, d, a, X[ 3], 22, 0xc1bdceee);
+        FF(a, b, c, d, X[ 4],  7, 0xf57c0faf);
+        FF(d, a, b, c, X[ 5], 12, 0x4787c62a);
+        FF(c, d, a, b, X[ 6], 17, 0xa8304613);
+        FF(b, c, d, a, X[ 7], 22, 0xfd469501);
+        FF(a, b, c, d, X[ 8],  7, 0x698098d8);
+        FF(d, a, b, c, X[ 9], 12, 0x8b44f7af);
+        FF(c, d, a, b, X[10], 17, 0xffff5bb1);
+        FF(b, c, d, a, X[11], 22, 0x895cd7be);
+        FF(a, b, c, d, X[12],  7, 0x6b901122);
+        FF(d, a, b, c, X[13], 12, 0xfd987193);
+        FF(c, d, a, b, X[14], 17, 0xa679438e);
+        FF(b, c, d, a, X[15], 22, 0x49b40821);
+
+        // Round 2
+        GG(a, b, c, d, X[ 1],  5, 0xf61e2562);
+        GG(d, a, b, c, X[ 6],  9, 0xc040b340);
+        GG(c, d, a, b, X[11], 14, 0x265e5a51);
+        GG(b, c, d, a, X[ 0], 20, 0xe9b6c7aa);
+        GG(a, b, c, d, X[ 5],  5, 0xd62f105d);
+        GG(d, a, b, c, X[10],  9, 0x02441453);
+        GG(c, d, a, b, X[15], 14, 0xd8a1e681);
+        GG(b, c, d, a, X[ 4], 20, 0xe7d3fbc8);
+        GG(a, b, c, d, X[ 9],  5, 0x21e1cde6);
+        GG(d, a, b, c, X[14],  9, 0xc33707d6);
+        GG(c, d, a, b, X[ 3], 14, 0xf4d50d87);
+        GG(b, c, d, a, X[ 8], 20, 0x455a14ed);
+        GG(a, b, c, d, X[13],  5, 0xa9e3e905);
+        GG(d, a, b, c, X[ 2],  9, 0xfcefa3f8);
+        GG(c, d, a, b, X[ 7], 14, 0x676f02d9);
+        GG(b, c, d, a, X[12], 20, 0x8d2a4c8a);
+
+        // Round 3
+        HH(a, b, c, d, X[ 5],  4, 0xfffa3942);
+        HH(d, a, b, c, X[ 8], 11, 0x8771f681);
+        HH(c, d, a, b, X[11], 16, 0x6d9d6122);
+        HH(b, c, d, a, X[14], 23, 0xfde5380c);
+        HH(a, b, c, d, X[ 1],  4, 0xa4beea44);
+        HH(d, a, b, c, X[ 4], 11, 0x4bdecfa9);
+        HH(c, d, a, b, X[ 7], 16, 0xf6bb4b60);
+        HH(b, c, d, a, X[10], 23, 0xbebfbc70);
+        HH(a, b, c, d, X[13],  4, 0x289b7ec6);
+        HH(d, a, b, c, X[ 0], 11, 0xeaa127fa);
+        HH(c, d, a, b, X[ 3], 16, 0xd4ef3085);
+        HH(b, c, d, a, X[ 6], 23, 0x04881d05);
+        HH(a, b, c, d, X[ 9],  4, 0xd9d4d039);
+        HH(d, a, b, c, X[12], 11, 0xe6db99e5);
+        HH(c, d, a, b, X[15], 16, 0x1fa27cf8);
+        HH(b, c, d, a, X[ 2], 23, 0xc4ac5665);
+
+        // Round 4
+        II(a, b, c, d, X[ 0],  6, 0xf4292244);
+        II(d, a, b, c, X[ 7], 10, 0x432aff97);
+        II(c, d, a, b, X[14], 15, 0xab9423a7);
+        II(b, c, d, a, X[ 5], 21, 0xfc93a039);
+        II(a, b, c, d, X[12],  6, 0x655b59c3);
+        II(d, a, b, c, X[ 3], 10, 0x8f0ccc92);
+        II(c, d, a, b, X[10], 15, 0xffeff47d);
+        II(b, c, d, a, X[ 1], 21, 0x85845dd1);
+        II(a, b, c, d, X[ 8],  6, 0x6fa87e4f);
+        II(d, a, b, c, X[15], 10, 0xfe2ce6e0);
+        II(c, d, a, b, X[ 6], 15, 0xa3014314);
+        II(b, c, d, a, X[13], 21, 0x4e0811a1);
+        II(a, b, c, d, X[ 4],  6, 0xf7537e82);
+        II(d, a, b, c, X[11], 10, 0xbd3af235);
+        II(c, d, a, b, X[ 2], 15, 0x2ad7d2bb);
+        II(b, c, d, a, X[ 9], 21, 0xeb86d391);
+
+        st[0] += a;
+        st[1] += b;
+        st[2] += c;
+        st[3] += d;
+    }
+
+private:
+    uint32_t state[4];      // A, B, C, D
+    uint64_t length;        // 已经输入的字节数
+    uint8_t buf[64];        // 不足一块的数据
+    size_t bufLen;
+
+/***********************  Some functions **************************/
+    // a <- b + ((a + g(b, c, d) + X[k] + T[i]) <<< s)
+    // F、G与原来的定义等价，少一次运算
+    // 参数都按引用传递，向量类型不经过函数调用的ABI
+    template <class W>
+    static MD5_INLINE void FF(W& a, const W& b, const W& c, const W& d, const W& x, int s, uint32_t t) {
+        a += (d ^ (b & (c ^ d))) + x + t;
+        rotl(a, s);
+        a += b;
+    }
+    template <class W>
+    static MD5_INLINE void GG(W& a, const W& b, const W& c, const W& d, const W& x, int s, uint32_t t) {
+        a += (c ^ (d & (b ^ c))) + x + t;
+        rotl(a, s);
+        a += b;
+    }
+    template <class W>
+    static MD5_INLINE void HH(W& a, const W& b, const W& c, const W& d, const W& x, int s, uint32_t t) {
+        a += (b ^ c ^ d) + x + t;
+        rotl(a, s);
+        a += b;
+    }
+    template <class W>
+    static MD5_INLINE void II(W& a, const W& b, const W& c, const W& d, const W& x, int s, uint32_t t) {
+        a += (c ^ (b | ~d)) + x + t;
+        rotl(a, s);
+        a += b;
+    }
+
+/*************************** Utils ********************************/
+    template <class W>
+    static MD5_INLINE void rotl(W& n, int s) {
+        n = (n << s) | (n >> (32 - s));
+    }
+
+    // MD5按小端读写32位字
+    static inline uint32_t load(const uint8_t* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    static inline void store(uint32_t x, uint8_t* p) {
+        p[0] = (uint8_t)x;
+        p[1] = (uint8_t)(x >> 8);
+        p[2] = (uint8_t)(x >> 16);
+        p[3] = (uint8_t)(x >> 24);
+    }
+};
+
+// hashFile的实现
+#include "MD5File.hpp"
+
+#endif
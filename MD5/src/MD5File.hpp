@@ -0,0 +1,145 @@
+#ifndef _MD5_FILE_HPP_
+#define _MD5_FILE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <stdio.h>
+#include <vector>
+#include "MD5Context.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define MD5_FILE_POSIX 1
+#endif
+
+// 读文件、计算文件的摘要
+// 大文件用mmap映射后直接交给MD5Context，不经过读缓冲区；小文件和管道等用普通的读。
+// 文件长度一律用64位整数表示。失败时返回false，errno中是错误原因。
+class MD5File {
+public:
+    // 不小于这个长度的普通文件使用mmap
+    static const uint64_t MMAP_THRESHOLD = 1 << 20;
+    // 每次映射的长度，32位的进程也能处理任意大小的文件
+    static const uint64_t MMAP_WINDOW = 1 << 30;
+    // 普通读的缓冲区大小
+    static const size_t READ_BUFFER_SIZE = 1 << 20;
+
+    // 计算文件的摘要，fileName为"-"时读标准输入；bytes为读到的字节数
+    static bool hash(const char* fileName, uint8_t digest[16], uint64_t& bytes) {
+        bytes = 0;
+        MD5Context ctx;
+#ifdef MD5_FILE_POSIX
+        bool isStdin = fileName[0] == '-' && fileName[1] == 0;
+        int fd = isStdin ? 0 : open(fileName, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        bool ok;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && (uint64_t)st.st_size >= MMAP_THRESHOLD)
+            ok = hashMapped(fd, (uint64_t)st.st_size, ctx, bytes);
+        else
+            ok = hashStream(fd, ctx, bytes);
+        int err = errno;
+        if (!isStdin) close(fd);
+        errno = err;
+        if (!ok) return false;
+#else
+        FILE* fp = fileName[0] == '-' && fileName[1] == 0 ? stdin : fopen(fileName, "rb");
+        if (!fp) return false;
+        std::vector<uint8_t> buffer(READ_BUFFER_SIZE);
+        size_t got;
+        while ((got = fread(&buffer[0], 1, buffer.size(), fp)) > 0) {
+            ctx.update(&buffer[0], got);
+            bytes += got;
+        }
+        bool failed = ferror(fp) != 0;
+        if (fp != stdin) fclose(fp);
+        if (failed) return false;
+#endif
+        ctx.final(digest);
+        return true;
+    }
+
+    // 把整个文件读到data中(用于小文件)
+    static bool read(const char* fileName, std::vector<uint8_t>& data) {
+        data.clear();
+#ifdef MD5_FILE_POSIX
+        int fd = open(fileName, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        // 按stat得到的长度多留一点，文件在此期间变长时再扩大
+        size_t expect = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) ? (size_t)st.st_size + 1 : 4096;
+        data.resize(expect);
+        size_t len = 0;
+        for (;;) {
+            if (len == data.size()) data.resize(data.size() * 2);
+            ssize_t got = ::read(fd, &data[len], data.size() - len);
+            if (got == 0) break;
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                int err = errno;
+                close(fd);
+                errno = err;
+                return false;
+            }
+            len += (size_t)got;
+        }
+        close(fd);
+        data.resize(len);
+        return true;
+#else
+        FILE* fp = fopen(fileName, "rb");
+        if (!fp) return false;
+        uint8_t buffer[1 << 16];
+        size_t got;
+        while ((got = fread(buffer, 1, sizeof(buffer), fp)) > 0) data.insert(data.end(), buffer, buffer + got);
+        bool failed = ferror(fp) != 0;
+        fclose(fp);
+        return !failed;
+#endif
+    }
+
+private:
+#ifdef MD5_FILE_POSIX
+    static bool hashMapped(int fd, uint64_t size, MD5Context& ctx, uint64_t& bytes) {
+        for (uint64_t off = 0; off < size; off += MMAP_WINDOW) {
+            size_t len = (size_t)(size - off < MMAP_WINDOW ? size - off : (uint64_t)MMAP_WINDOW);
+            void* p = mmap(0, len, PROT_READ, MAP_PRIVATE, fd, (off_t)off);
+            // 映射失败(如某些文件系统不支持)时从这里开始改用普通的读
+            if (p == MAP_FAILED) {
+                if (lseek(fd, (off_t)off, SEEK_SET) < 0) return false;
+                return hashStream(fd, ctx, bytes);
+            }
+            madvise(p, len, MADV_SEQUENTIAL);
+            ctx.update(p, len);
+            munmap(p, len);
+            bytes += len;
+        }
+        return true;
+    }
+
+    static bool hashStream(int fd, MD5Context& ctx, uint64_t& bytes) {
+        std::vector<uint8_t> buffer(READ_BUFFER_SIZE);
+        for (;;) {
+            ssize_t got = ::read(fd, &buffer[0], buffer.size());
+            if (got == 0) return true;
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            ctx.update(&buffer[0], (size_t)got);
+            bytes += (uint64_t)got;
+        }
+    }
+#endif
+};
+
+inline bool MD5Context::hashFile(const char* fileName, uint8_t digest[16]) {
+    uint64_t bytes;
+    return MD5File::hash(fileName, digest, bytes);
+}
+
+#endif
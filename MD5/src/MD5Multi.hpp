@@ -0,0 +1,226 @@
+#ifndef _MD5_MULTI_HPP_
+#define _MD5_MULTI_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "MD5Context.hpp"
+
+// Multi-buffer MD5: 同时计算多条互不相关的消息的摘要。
+// 单条消息的MD5只能逐块串行计算，但不同消息之间没有依赖，
+// 把4/8/16条消息分别放在SSE2/AVX2/AVX-512寄存器的各个32位元素里，
+// 用同一份64步的代码(MD5Context::rounds)同时推进。
+// 运行时根据CPU选择最宽的实现，其他平台上退回到逐条计算。
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MD5_MULTI_X86 1
+#endif
+
+// 一段要计算摘要的数据
+struct MD5Span {
+    const void* data;
+    size_t len;
+};
+
+class MD5Multi {
+public:
+    // 当前CPU上同时计算的消息条数: 16、8、4，或者1(逐条计算)
+    static size_t lanes() {
+        static const size_t n = detectLanes();
+        return n;
+    }
+
+    // 计算n段数据的摘要，digests[i]对应spans[i]
+    // 先结束的通道立刻从队列中取下一条消息，长短不一的消息也不会让通道空闲
+    static void hash(const MD5Span spans[], size_t n, uint8_t digests[][16]) {
+        switch (lanes()) {
+#ifdef MD5_MULTI_X86
+            case 16: schedule<16>(spans, n, digests, kernel16); return;
+            case 8:  schedule<8>(spans, n, digests, kernel8); return;
+#endif
+#ifdef __GNUC__
+            case 4:  schedule<4>(spans, n, digests, kernel4); return;
+#endif
+            default:
+                for (size_t i = 0; i < n; i++) MD5Context::hash(spans[i].data, spans[i].len, digests[i]);
+        }
+    }
+
+private:
+    // 压缩各通道的一个块，state按 A[L], B[L], C[L], D[L] 存放
+    typedef void (*Kernel)(uint32_t* state, const uint8_t* const* blocks);
+
+    // 通道所处的阶段：消息中完整的块、填充后的最后1~2块、空闲
+    enum Stage { BODY, TAIL, IDLE };
+
+    template <int L>
+    struct Lanes {
+        uint32_t state[4 * L];
+        const uint8_t* ptr[L];      // 下一个要压缩的块
+        size_t left[L];             // 当前阶段还剩的块数
+        size_t msg[L];              // 正在计算的消息的下标
+        Stage stage[L];
+        uint8_t tail[L][128];       // 消息末尾不足一块的部分加上填充
+    };
+
+    template <int L>
+    static void schedule(const MD5Span spans[], size_t n, uint8_t digests[][16], Kernel kernel) {
+        static const uint8_t idle[64] = {0};
+        Lanes<L> s;
+        size_t next = 0, active = 0;
+        for (int l = 0; l < L; l++) {
+            s.stage[l] = IDLE;
+            s.ptr[l] = idle;
+            if (fetch(s, l, spans, n, next)) active++;
+        }
+
+        while (active > 0) {
+            // 队列已空、只剩很少几条消息时，逐条计算更快
+            if (next == n && (active == 1 || active * 8 <= (size_t)L)) {
+                for (int l = 0; l < L; l++)
+                    if (s.stage[l] != IDLE) finishScalar(s, l, spans, digests);
+                return;
+            }
+
+            kernel(s.state, s.ptr);
+
+            for (int l = 0; l < L; l++) {
+                if (s.stage[l] == IDLE) continue;
+                s.ptr[l] += 64;
+                if (--s.left[l] > 0) continue;
+                if (s.stage[l] == BODY) {
+                    startTail(s, l, spans[s.msg[l]]);
+                    continue;
+                }
+                output(s, l, digests[s.msg[l]]);
+                if (!fetch(s, l, spans, n, next)) {
+                    s.stage[l] = IDLE;
+                    s.ptr[l] = idle;
+                    active--;
+                }
+            }
+        }
+    }
+
+    // 从队列中取下一条消息放到通道l，队列为空时返回false
+    template <int L>
+    static bool fetch(Lanes<L>& s, int l, const MD5Span spans[], size_t n, size_t& next) {
+        if (next == n) return false;
+        size_t i = next++;
+        s.msg[l] = i;
+        s.state[0*L + l] = 0x67452301;
+        s.state[1*L + l] = 0xEFCDAB89;
+        s.state[2*L + l] = 0x98BADCFE;
+        s.state[3*L + l] = 0x10325476;
+        s.stage[l] = BODY;
+        s.ptr[l] = (const uint8_t*)spans[i].data;
+        s.left[l] = spans[i].len / 64;
+        if (s.left[l] == 0) startTail(s, l, spans[i]);
+        return true;
+    }
+
+    // 消息的完整块已经处理完，换成填充后的最后1~2块
+    template <int L>
+    static void startTail(Lanes<L>& s, int l, const MD5Span& span) {
+        size_t rem = span.len % 64;
+        uint64_t bits = (uint64_t)span.len * 8;
+        uint8_t* t = s.tail[l];
+        size_t blocks = rem < 56 ? 1 : 2;
+
+        // {NULL, 0}这样的空消息不能传给memcpy
+        if (rem) memcpy(t, (const uint8_t*)span.data + span.len - rem, rem);
+        t[rem] = 0x80;
+        memset(t + rem + 1, 0, 64*blocks - rem - 1);
+        for (int i = 0; i < 8; i++) t[64*blocks - 8 + i] = (uint8_t)(bits >> (8*i));
+
+        s.stage[l] = TAIL;
+        s.ptr[l] = t;
+        s.left[l] = blocks;
+    }
+
+    template <int L>
+    static void output(const Lanes<L>& s, int l, uint8_t digest[16]) {
+        for (int j = 0; j < 4; j++) {
+            uint32_t x = s.state[j*L + l];
+            for (int b = 0; b < 4; b++) digest[4*j + b] = (uint8_t)(x >> (8*b));
+        }
+    }
+
+    // 用标量实现算完通道l上的消息
+    template <int L>
+    static void finishScalar(Lanes<L>& s, int l, const MD5Span spans[], uint8_t digests[][16]) {
+        uint32_t st[4];
+        for (int j = 0; j < 4; j++) st[j] = s.state[j*L + l];
+        MD5Context::compress(st, s.ptr[l], s.left[l]);
+        if (s.stage[l] == BODY) {
+            startTail(s, l, spans[s.msg[l]]);
+            MD5Context::compress(st, s.ptr[l], s.left[l]);
+        }
+        for (int j = 0; j < 4; j++) s.state[j*L + l] = st[j];
+        output(s, l, digests[s.msg[l]]);
+        s.stage[l] = IDLE;
+    }
+
+    static size_t detectLanes() {
+#ifdef MD5_MULTI_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return 16;
+        if (__builtin_cpu_supports("avx2")) return 8;
+        if (__builtin_cpu_supports("sse2")) return 4;
+        return 1;
+#elif defined(__GNUC__)
+        return 4;
+#else
+        return 1;
+#endif
+    }
+
+#ifdef __GNUC__
+    typedef uint32_t u32x4 __attribute__((vector_size(16)));
+
+#ifdef MD5_MULTI_X86
+    typedef uint32_t u32x8 __attribute__((vector_size(32)));
+    typedef uint32_t u32x16 __attribute__((vector_size(64)));
+
+    __attribute__((target("sse2")))
+    static void kernel4(uint32_t* state, const uint8_t* const* blocks) {
+        compress<u32x4, 4>(state, blocks);
+    }
+
+    __attribute__((target("avx2")))
+    static void kernel8(uint32_t* state, const uint8_t* const* blocks) {
+        compress<u32x8, 8>(state, blocks);
+    }
+
+    __attribute__((target("avx512f")))
+    static void kernel16(uint32_t* state, const uint8_t* const* blocks) {
+        compress<u32x16, 16>(state, blocks);
+    }
+#else
+    static void kernel4(uint32_t* state, const uint8_t* const* blocks) {
+        compress<u32x4, 4>(state, blocks);
+    }
+#endif
+
+    // W由L个32位元素组成，第l个元素属于第l条消息
+    template <class W, int L>
+    static MD5_INLINE void compress(uint32_t* state, const uint8_t* const* blocks) {
+        // 第i个字的各通道排在一起
+        uint32_t words[16][L];
+        for (int l = 0; l < L; l++) {
+            const uint8_t* p = blocks[l];
+            for (int i = 0; i < 16; i++, p += 4)
+                words[i][l] = (uint32_t)p[0] | ((uint32_t)p[1] << 8)
+                            | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        }
+
+        W X[16], st[4];
+        memcpy(X, words, sizeof(X));
+        memcpy(st, state, sizeof(st));
+        MD5Context::rounds(st, X);
+        memcpy(state, st, sizeof(st));
+    }
+#endif
+};
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef _WORK_STEALING_POOL_HPP_
+#define _WORK_STEALING_POOL_HPP_
+
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取(work-stealing)线程池
+// 每个线程有自己的任务队列，从队头取任务；自己的队列空了就从别的线程的队尾偷。
+// 提交的任务轮流放到各个队列里，大致按提交的顺序完成。
+class WorkStealingPool {
+public:
+    typedef std::function<void()> Task;
+
+    // threads为0时使用CPU的核数
+    explicit WorkStealingPool(unsigned threads = 0)
+        : pending(0), queued(0), stopping(false), nextQueue(0) {
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+        queues = std::vector<Queue>(threads);
+        for (unsigned i = 0; i < threads; i++)
+            workers.push_back(std::thread(&WorkStealingPool::work, this, i));
+    }
+
+    // 等所有任务完成后退出
+    ~WorkStealingPool() {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+    }
+
+    unsigned size() const { return (unsigned)queues.size(); }
+
+    void submit(const Task& task) {
+        Queue& q = queues[nextQueue++ % queues.size()];
+        // 先计数再放入队列，queued不会小于队列中实际的任务数
+        {
+            std::lock_guard<std::mutex> lock(m);
+            pending++;
+            queued++;
+        }
+        {
+            std::lock_guard<std::mutex> lock(q.m);
+            q.tasks.push_back(task);
+        }
+        wake.notify_one();
+    }
+
+    // 等到已提交的任务全部完成
+    void wait() {
+        std::unique_lock<std::mutex> lock(m);
+        idle.wait(lock, [this] { return pending == 0; });
+    }
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<Queue> queues;
+    std::vector<std::thread> workers;
+
+    // 以下三项由m保护
+    std::mutex m;
+    std::condition_variable wake, idle;
+    size_t pending;     // 还没有完成的任务数
+    size_t queued;      // 还在队列中的任务数
+    bool stopping;
+    std::atomic<size_t> nextQueue;
+
+    void work(unsigned self) {
+        for (;;) {
+            Task task;
+            if (take(self, task)) {
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    queued--;
+                }
+                task();
+                std::lock_guard<std::mutex> lock(m);
+                if (--pending == 0) idle.notify_all();
+                continue;
+            }
+
+            // 所有队列都空了才睡眠
+            std::unique_lock<std::mutex> lock(m);
+            wake.wait(lock, [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0) return;
+        }
+    }
+
+    // 先取自己队头的任务，再从其他队列的队尾偷
+    bool take(unsigned self, Task& task) {
+        {
+            Queue& q = queues[self];
+            std::lock_guard<std::mutex> lock(q.m);
+            if (!q.tasks.empty()) {
+                task.swap(q.tasks.front());
+                q.tasks.pop_front();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); i++) {
+            Queue& q = queues[(self + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.m);
+            if (!q.tasks.empty()) {
+                task.swap(q.tasks.back());
+                q.tasks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif
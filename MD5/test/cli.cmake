@@ -0,0 +1,92 @@
+# MD5命令行程序的测试，由ctest以 cmake -DMD5=... -DWORK_DIR=... -P cli.cmake 运行
+# 1. 对一个临时目录计算摘要，其中的文件名含有反斜杠和换行(md5sum格式中要转义)，
+#    还有空文件和超过mmap阈值的大文件；摘要与CMake的file(MD5)比较
+# 2. MD5 -c 检查它自己的输出，退出码为0
+# 3. 改坏一行的摘要、列出不存在的文件、没有一行格式正确时，-c的退出码不为0；
+#    与md5sum相同，其余各行都正确时格式不对的行只给出警告
+
+if(NOT MD5 OR NOT WORK_DIR)
+    message(FATAL_ERROR "usage: cmake -DMD5=<program> -DWORK_DIR=<dir> -P cli.cmake")
+endif()
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}/tree/sub")
+
+# 文件名(相对于WORK_DIR)和在输出中转义后的样子
+set(names "tree/back\\slash" "tree/new\nline" "tree/empty" "tree/sub/plain" "tree/sub/big")
+set(escaped "tree/back\\\\slash" "tree/new\\nline" "tree/empty" "tree/sub/plain" "tree/sub/big")
+file(WRITE "${WORK_DIR}/tree/back\\slash" "a")
+file(WRITE "${WORK_DIR}/tree/new\nline" "b")
+file(WRITE "${WORK_DIR}/tree/empty" "")
+file(WRITE "${WORK_DIR}/tree/sub/plain" "The quick brown fox jumps over the lazy dog")
+string(REPEAT "0123456789abcdef" 131072 big)
+file(WRITE "${WORK_DIR}/tree/sub/big" "${big}x")
+
+function(run expectZero)
+    execute_process(COMMAND "${MD5}" ${ARGN}
+                    WORKING_DIRECTORY "${WORK_DIR}"
+                    RESULT_VARIABLE rc OUTPUT_VARIABLE out ERROR_VARIABLE err)
+    if(expectZero AND NOT rc EQUAL 0)
+        message(FATAL_ERROR "MD5 ${ARGN}: exit status ${rc}\n${out}${err}")
+    elseif(NOT expectZero AND rc EQUAL 0)
+        message(FATAL_ERROR "MD5 ${ARGN}: exit status 0, expected failure\n${out}${err}")
+    endif()
+    set(out "${out}" PARENT_SCOPE)
+    set(err "${err}" PARENT_SCOPE)
+endfunction()
+
+# 1. 计算摘要，每个文件一行
+run(TRUE tree)
+file(WRITE "${WORK_DIR}/sums" "${out}")
+foreach(i RANGE 4)
+    list(GET names ${i} name)
+    list(GET escaped ${i} shown)
+    file(MD5 "${WORK_DIR}/${name}" digest)
+    set(line "${digest}  ${shown}\n")
+    if(NOT name STREQUAL shown)
+        set(line "\\${line}")
+    endif()
+    string(FIND "${out}" "${line}" pos)
+    if(pos EQUAL -1)
+        message(FATAL_ERROR "missing line: ${line}output:\n${out}")
+    endif()
+endforeach()
+
+# 2. 检查自己的输出
+run(TRUE -c sums)
+string(REGEX MATCHALL ": OK\n" ok "${out}")
+list(LENGTH ok count)
+if(NOT count EQUAL 5)
+    message(FATAL_ERROR "MD5 -c sums: ${count} files OK, expected 5\n${out}")
+endif()
+
+# 3. 改坏含有转义的那一行的摘要
+file(READ "${WORK_DIR}/sums" sums)
+file(MD5 "${WORK_DIR}/tree/back\\slash" digest)
+string(REPLACE "\\${digest}" "\\00000000000000000000000000000000" corrupted "${sums}")
+if(corrupted STREQUAL sums)
+    message(FATAL_ERROR "could not corrupt the checksum file:\n${sums}")
+endif()
+file(WRITE "${WORK_DIR}/corrupted" "${corrupted}")
+run(FALSE -c corrupted)
+string(FIND "${out}" "tree/back\\\\slash: FAILED" pos)
+if(pos EQUAL -1)
+    message(FATAL_ERROR "MD5 -c corrupted: no FAILED line\n${out}")
+endif()
+run(FALSE -c --status corrupted)
+if(NOT out STREQUAL "")
+    message(FATAL_ERROR "MD5 -c --status printed:\n${out}")
+endif()
+
+file(WRITE "${WORK_DIR}/malformed" "${sums}not a checksum line\n")
+run(TRUE -c malformed)
+string(FIND "${err}" "1 line is improperly formatted" pos)
+if(pos EQUAL -1)
+    message(FATAL_ERROR "MD5 -c malformed: no warning\n${err}")
+endif()
+file(WRITE "${WORK_DIR}/malformed" "not a checksum line\n")
+run(FALSE -c malformed)
+file(WRITE "${WORK_DIR}/missing" "${sums}d41d8cd98f00b204e9800998ecf8427e  tree/missing\n")
+run(FALSE -c missing)
+
+file(REMOVE_RECURSE "${WORK_DIR}")
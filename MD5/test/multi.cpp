@@ -0,0 +1,105 @@
+// MD5Multi::hash against MD5Context::hash for every message: batches with fewer,
+// exactly as many and more messages than lanes(), mixed lengths around the
+// 56/64-byte padding boundaries and long messages, and {NULL, 0} spans.
+// Exits non-zero on any mismatch.
+//
+// g++ multi.cpp -o multi -std=c++11 -O2 -I../src
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "MD5Multi.hpp"
+
+using namespace std;
+
+static int failures = 0;
+
+static void toHex(const uint8_t digest[16], char hex[33]) {
+    for (int i = 0; i < 16; i++) sprintf(hex + 2*i, "%02x", digest[i]);
+}
+
+static uint32_t next(uint32_t& x) {
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return x;
+}
+
+// 逐条与MD5Context比较
+static void check(const string& what, const vector<MD5Span>& spans) {
+    size_t n = spans.size();
+    // 多分配一条，检查没有写到digests之外
+    vector<uint8_t> digests((n + 1) * 16, 0xA5);
+    MD5Multi::hash(n ? &spans[0] : NULL, n, (uint8_t(*)[16])&digests[0]);
+
+    for (size_t i = 0; i < n; i++) {
+        uint8_t expect[16];
+        MD5Context::hash(spans[i].data, spans[i].len, expect);
+        if (memcmp(&digests[i * 16], expect, 16) == 0) continue;
+        if (++failures <= 10) {
+            char g[33], e[33];
+            toHex(&digests[i * 16], g);
+            toHex(expect, e);
+            printf("MISMATCH %s: message %zu of %zu (length %zu): got %s expect %s\n",
+                   what.c_str(), i, n, spans[i].len, g, e);
+        }
+    }
+    for (size_t i = n * 16; i < digests.size(); i++) {
+        if (digests[i] == 0xA5) continue;
+        if (++failures <= 10) printf("MISMATCH %s: wrote past digest %zu\n", what.c_str(), n);
+        break;
+    }
+}
+
+int main(void) {
+    const size_t LENGTHS[] = { 0, 1, 55, 56, 63, 64, 65, 119, 120, 127, 128, 1000, 4096, 100000 };
+    const size_t NLENGTHS = sizeof(LENGTHS) / sizeof(LENGTHS[0]);
+    const size_t L = MD5Multi::lanes();
+
+    vector<uint8_t> data(1 << 20);
+    uint32_t x = 2463534242u;
+    for (size_t i = 0; i < data.size(); i++) data[i] = (uint8_t)next(x);
+
+    // 比通道数少、相等、多的消息条数
+    vector<size_t> counts;
+    counts.push_back(0);
+    counts.push_back(1);
+    if (L > 1) counts.push_back(L - 1);
+    counts.push_back(L);
+    counts.push_back(L + 1);
+    counts.push_back(2 * L + 3);
+    counts.push_back(100);
+
+    // 每种长度的消息各自成批，所有通道同时结束
+    for (size_t k = 0; k < NLENGTHS; k++) {
+        for (size_t c = 0; c < counts.size(); c++) {
+            vector<MD5Span> spans(counts[c]);
+            for (size_t i = 0; i < spans.size(); i++) {
+                spans[i].len = LENGTHS[k];
+                spans[i].data = &data[next(x) % (data.size() - LENGTHS[k])];
+            }
+            check("equal lengths " + to_string(LENGTHS[k]), spans);
+        }
+    }
+
+    // 长度混在一起，通道先后结束、从队列中取下一条；其中有{NULL, 0}
+    for (size_t c = 0; c < counts.size(); c++) {
+        for (int r = 0; r < 20; r++) {
+            vector<MD5Span> spans(counts[c]);
+            for (size_t i = 0; i < spans.size(); i++) {
+                size_t len = LENGTHS[next(x) % NLENGTHS];
+                if (next(x) % 4 == 0) len += next(x) % 200;
+                spans[i].len = len;
+                spans[i].data = &data[next(x) % (data.size() - len)];
+                if (len == 0 && next(x) % 2) spans[i].data = NULL;
+            }
+            check("mixed lengths, " + to_string(counts[c]) + " messages", spans);
+        }
+    }
+
+    if (failures) {
+        printf("%d mismatches\n", failures);
+        return 1;
+    }
+    printf("OK: MD5Multi (%zu lanes) matches MD5Context for mixed lengths and message counts\n", L);
+    return 0;
+}
@@ -0,0 +1,132 @@
+// RFC 1321 test suite for MD5Context, plus incremental update() against the
+// one-shot hash(): byte at a time, and random splits over lengths around the
+// 56/64-byte padding boundaries. Exits non-zero on any mismatch.
+//
+// g++ rfc1321.cpp -o rfc1321 -std=c++11 -O2 -I../src
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "MD5Context.hpp"
+
+using namespace std;
+
+static int failures = 0;
+
+static void toHex(const uint8_t digest[16], char hex[33]) {
+    for (int i = 0; i < 16; i++) sprintf(hex + 2*i, "%02x", digest[i]);
+}
+
+static void check(const char* what, size_t len, const uint8_t got[16], const uint8_t expect[16]) {
+    if (memcmp(got, expect, 16) == 0) return;
+    if (++failures <= 10) {
+        char g[33], e[33];
+        toHex(got, g);
+        toHex(expect, e);
+        printf("MISMATCH %s (length %zu): got %s expect %s\n", what, len, g, e);
+    }
+}
+
+// RFC 1321 附录A.5
+static void suite() {
+    static const char* const TESTS[7][2] = {
+        { "", "d41d8cd98f00b204e9800998ecf8427e" },
+        { "a", "0cc175b9c0f1b6a831c399e269772661" },
+        { "abc", "900150983cd24fb0d6963f7d28e17f72" },
+        { "message digest", "f96b697d7cb7938d525a2f31aaf161d0" },
+        { "abcdefghijklmnopqrstuvwxyz", "c3fcd3d76192e4007dfb496cca67e13b" },
+        { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+          "d174ab98d277d9f5a5611c2c9f419d9f" },
+        { "12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+          "57edf4a22be3c955ac49da2e2107b67a" },
+    };
+    for (int t = 0; t < 7; t++) {
+        const char* msg = TESTS[t][0];
+        size_t len = strlen(msg);
+        uint8_t expect[16], digest[16];
+        for (int i = 0; i < 16; i++) sscanf(TESTS[t][1] + 2*i, "%2hhx", &expect[i]);
+
+        MD5Context::hash(msg, len, digest);
+        check("RFC 1321 hash", len, digest, expect);
+
+        MD5Context ctx;
+        for (size_t i = 0; i < len; i++) ctx.update(msg + i, 1);
+        ctx.final(digest);
+        check("RFC 1321 byte at a time", len, digest, expect);
+
+        // 长度为0的update可以传NULL
+        ctx.init();
+        ctx.update(NULL, 0);
+        ctx.update(msg, len);
+        ctx.update(NULL, 0);
+        ctx.final(digest);
+        check("RFC 1321 with empty NULL updates", len, digest, expect);
+    }
+
+    uint8_t expect[16], digest[16];
+    MD5Context::hash("", 0, expect);
+    MD5Context::hash(NULL, 0, digest);
+    check("hash(NULL, 0)", 0, digest, expect);
+}
+
+// 分段update与一次hash的结果比较
+static void splits() {
+    vector<uint8_t> data(5000);
+    uint32_t x = 2463534242u;
+    for (size_t i = 0; i < data.size(); i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        data[i] = (uint8_t)x;
+    }
+
+    vector<size_t> lengths;
+    for (size_t len = 0; len <= 200; len++) lengths.push_back(len);
+    lengths.push_back(1000);
+    lengths.push_back(4095);
+    lengths.push_back(4096);
+    lengths.push_back(5000);
+
+    MD5Context ctx;
+    for (size_t k = 0; k < lengths.size(); k++) {
+        size_t len = lengths[k];
+        uint8_t expect[16], digest[16];
+        MD5Context::hash(&data[0], len, expect);
+
+        ctx.init();
+        for (size_t i = 0; i < len; i++) ctx.update(&data[i], 1);
+        ctx.final(digest);
+        check("byte at a time", len, digest, expect);
+
+        for (int r = 0; r < 20; r++) {
+            ctx.init();
+            size_t done = 0;
+            while (done < len) {
+                x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+                // 大多数是短的片段，偶尔跨过好几个块；也包括长度为0的update
+                size_t piece = x % 8 == 0 ? x % 300 : x % 70;
+                if (piece > len - done) piece = len - done;
+                ctx.update(&data[done], piece);
+                done += piece;
+            }
+            ctx.final(digest);
+            check("random split", len, digest, expect);
+        }
+
+        // final之后init，同一个对象可以重复使用
+        ctx.init();
+        ctx.update(&data[0], len);
+        ctx.final(digest);
+        check("reused context", len, digest, expect);
+    }
+}
+
+int main(void) {
+    suite();
+    splits();
+
+    if (failures) {
+        printf("%d mismatches\n", failures);
+        return 1;
+    }
+    printf("OK: RFC 1321 suite and incremental updates match one-shot hash\n");
+    return 0;
+}
@@ -0,0 +1,319 @@
+/*!
+ * @file       BenchHarness.hpp
+ * @brief      基准测试的公共部分：计时、周期数、可选的硬件计数器和JSON输出
+ *             每一项测试先估计循环次数，使一次测量至少持续minTime秒，
+ *             再重复测量repeats次，取最快的一次。
+ *             周期数优先使用perf_event的cycles计数器，不可用时使用TSC。
+ */
+
+#ifndef _BENCH_HARNESS_HPP_
+#define _BENCH_HARNESS_HPP_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BENCH_HAS_PERF 1
+#endif
+
+/**
+ * @brief      一次测量得到的硬件计数器，没有的项为-1
+ */
+struct BenchCounters {
+    int64_t cycles;
+    int64_t instructions;
+    int64_t branchMisses;
+    int64_t cacheMisses;
+
+    BenchCounters() : cycles(-1), instructions(-1), branchMisses(-1), cacheMisses(-1) {}
+};
+
+/**
+ * @brief      用perf_event读取当前进程(包括之后创建的线程)在用户态的计数
+ *             内核不允许或者没有PMU(如大多数虚拟机)时available()为false
+ */
+class PerfCounters {
+
+public:
+    PerfCounters() {
+        for (int i = 0; i < COUNT; i++) fd[i] = -1;
+    }
+
+    ~PerfCounters() {
+        for (int i = 0; i < COUNT; i++) closeCounter(i);
+    }
+
+    // 打开各个计数器，至少有一个可用时返回true
+    bool open() {
+#ifdef BENCH_HAS_PERF
+        static const uint64_t CONFIG[COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES
+        };
+        for (int i = 0; i < COUNT; i++) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = CONFIG[i];
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+#endif
+        return available();
+    }
+
+    bool available() const {
+        for (int i = 0; i < COUNT; i++)
+            if (fd[i] >= 0) return true;
+        return false;
+    }
+
+    void start() {
+#ifdef BENCH_HAS_PERF
+        for (int i = 0; i < COUNT; i++) {
+            if (fd[i] < 0) continue;
+            ioctl(fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    BenchCounters stop() {
+        int64_t v[COUNT];
+        for (int i = 0; i < COUNT; i++) v[i] = -1;
+#ifdef BENCH_HAS_PERF
+        for (int i = 0; i < COUNT; i++) {
+            if (fd[i] < 0) continue;
+            ioctl(fd[i], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t x;
+            if (read(fd[i], &x, sizeof(x)) == (ssize_t)sizeof(x)) v[i] = (int64_t)x;
+        }
+#endif
+        BenchCounters c;
+        c.cycles = v[0];
+        c.instructions = v[1];
+        c.branchMisses = v[2];
+        c.cacheMisses = v[3];
+        return c;
+    }
+
+private:
+    static const int COUNT = 4;
+    int fd[COUNT];
+
+    void closeCounter(int i) {
+#ifdef BENCH_HAS_PERF
+        if (fd[i] >= 0) close(fd[i]);
+#endif
+        fd[i] = -1;
+    }
+};
+
+/**
+ * @brief      阻止编译器把被测的计算当作无用代码删掉
+ */
+template <class T>
+inline void benchKeep(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+struct BenchResult {
+    std::string name;
+    uint64_t bytes;             // 每次迭代处理的字节数
+    uint64_t iterations;
+    double seconds;             // 最快一次测量的总时间
+    double cycles;              // 同一次测量的周期数，没有时为-1
+    const char* cycleSource;    // "perf"、"tsc"或"none"
+    BenchCounters counters;
+};
+
+class BenchHarness {
+
+public:
+    /**
+     * @param[in]  minTime  每次测量至少持续的秒数
+     * @param[in]  repeats  重复测量的次数，取最快的一次
+     * @param[in]  filter   只运行名字中含有这个字符串的测试，空串表示全部
+     * @param[in]  perf     是否尝试使用perf_event硬件计数器
+     */
+    BenchHarness(double minTime, int repeats, const std::string& filter, bool perf)
+        : minTime(minTime), repeats(repeats), filter(filter), perfRequested(perf) {
+        if (perfRequested) perf_.open();
+    }
+
+    bool perfAvailable() const {
+        return perf_.available();
+    }
+
+    bool enabled(const std::string& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    /**
+     * @brief      测量f，每调用一次f处理bytes字节
+     */
+    template <class F>
+    void run(const std::string& name, uint64_t bytes, F f) {
+        if (!enabled(name)) return;
+
+        // 估计循环次数
+        uint64_t iterations = 1;
+        for (;;) {
+            double t = measure(f, iterations).seconds;
+            if (t >= minTime) break;
+            double scale = t > 0 ? minTime / t * 1.2 : 100;
+            if (scale > 100) scale = 100;
+            if (scale < 2) scale = 2;
+            iterations = (uint64_t)(iterations * scale) + 1;
+        }
+
+        BenchResult best = measure(f, iterations);
+        for (int r = 1; r < repeats; r++) {
+            BenchResult x = measure(f, iterations);
+            if (x.seconds < best.seconds) best = x;
+        }
+        best.name = name;
+        best.bytes = bytes;
+        results.push_back(best);
+
+        double perByte = best.seconds * 1e9 / (double)(bytes * iterations);
+        fprintf(stderr, "%-28s %10llu B  %10.1f MB/s  %8.3f ns/B", name.c_str(),
+                (unsigned long long)bytes, bytes * iterations / best.seconds / 1e6, perByte);
+        if (best.cycles >= 0)
+            fprintf(stderr, "  %8.3f cycles/B (%s)", best.cycles / (double)(bytes * iterations),
+                    best.cycleSource);
+        fprintf(stderr, "\n");
+    }
+
+    /**
+     * @brief      输出JSON，extra是附加在顶层对象中的若干 "key": value 项
+     */
+    void writeJson(FILE* out, const std::vector<std::pair<std::string, std::string> >& extra) const {
+        char stamp[32];
+        time_t now = time(0);
+        strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+        fprintf(out, "{\n");
+        fprintf(out, "  \"schema\": 1,\n");
+        fprintf(out, "  \"timestamp\": \"%s\",\n", stamp);
+        for (size_t i = 0; i < extra.size(); i++)
+            fprintf(out, "  \"%s\": %s,\n", extra[i].first.c_str(), extra[i].second.c_str());
+        fprintf(out, "  \"min_time\": %g,\n", minTime);
+        fprintf(out, "  \"repeats\": %d,\n", repeats);
+        fprintf(out, "  \"perf_counters\": \"%s\",\n",
+                !perfRequested ? "disabled" : (perf_.available() ? "enabled" : "unavailable"));
+        fprintf(out, "  \"results\": [\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult& r = results[i];
+            double total = (double)(r.bytes * r.iterations);
+            fprintf(out, "    {\"name\": \"%s\", \"bytes\": %llu, \"iterations\": %llu, ",
+                    r.name.c_str(), (unsigned long long)r.bytes, (unsigned long long)r.iterations);
+            fprintf(out, "\"seconds\": %.9g, \"mb_per_s\": %.6g, \"ns_per_byte\": %.6g, ",
+                    r.seconds, total / r.seconds / 1e6, r.seconds * 1e9 / total);
+            if (r.cycles >= 0) fprintf(out, "\"cycles_per_byte\": %.6g, ", r.cycles / total);
+            else fprintf(out, "\"cycles_per_byte\": null, ");
+            fprintf(out, "\"cycle_source\": \"%s\", \"counters\": ", r.cycleSource);
+            writeCounters(out, r.counters, total);
+            fprintf(out, "}%s\n", i + 1 < results.size() ? "," : "");
+        }
+        fprintf(out, "  ]\n}\n");
+    }
+
+    // 转义后的JSON字符串(带引号)
+    static std::string quote(const std::string& s) {
+        std::string re = "\"";
+        for (size_t i = 0; i < s.size(); i++) {
+            unsigned char c = (unsigned char)s[i];
+            if (c == '"' || c == '\\') { re += '\\'; re += (char)c; }
+            else if (c < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                re += buf;
+            }
+            else re += (char)c;
+        }
+        return re + "\"";
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    double minTime;
+    int repeats;
+    std::string filter;
+    bool perfRequested;
+    PerfCounters perf_;
+    std::vector<BenchResult> results;
+
+    template <class F>
+    BenchResult measure(F& f, uint64_t iterations) {
+        BenchResult r;
+        r.iterations = iterations;
+        r.cycles = -1;
+        r.cycleSource = "none";
+
+        if (perf_.available()) perf_.start();
+#ifdef BENCH_HAS_TSC
+        uint64_t c0 = __rdtsc();
+#endif
+        Clock::time_point t0 = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++) f();
+        Clock::time_point t1 = Clock::now();
+#ifdef BENCH_HAS_TSC
+        uint64_t c1 = __rdtsc();
+        r.cycles = (double)(c1 - c0);
+        r.cycleSource = "tsc";
+#endif
+        if (perf_.available()) {
+            r.counters = perf_.stop();
+            if (r.counters.cycles >= 0) {
+                r.cycles = (double)r.counters.cycles;
+                r.cycleSource = "perf";
+            }
+        }
+        r.seconds = std::chrono::duration<double>(t1 - t0).count();
+        return r;
+    }
+
+    static void writeCounters(FILE* out, const BenchCounters& c, double total) {
+        if (c.instructions < 0 && c.branchMisses < 0 && c.cacheMisses < 0) {
+            fprintf(out, "null");
+            return;
+        }
+        fprintf(out, "{");
+        writeCounter(out, "instructions_per_byte", c.instructions, total, ", ");
+        writeCounter(out, "branch_misses_per_kb", c.branchMisses, total / 1024, ", ");
+        writeCounter(out, "cache_misses_per_kb", c.cacheMisses, total / 1024, "");
+        fprintf(out, "}");
+    }
+
+    static void writeCounter(FILE* out, const char* key, int64_t v, double per, const char* sep) {
+        if (v < 0) fprintf(out, "\"%s\": null%s", key, sep);
+        else fprintf(out, "\"%s\": %.6g%s", key, v / per, sep);
+    }
+};
+
+#endif
@@ -0,0 +1,288 @@
+/*!
+ * @file       bench.cpp
+ * @brief      DES和MD5的基准测试，对不同的输入长度测量吞吐量和每字节的周期数，
+ *             结果以JSON输出，便于比较不同版本之间的性能变化
+ *
+ *             用法: bench [--filter 名字] [--min-time 秒] [--repeats n] [--perf] [--out 文件]
+ *             --perf 打开perf_event计数器(指令数、分支预测失败、缓存缺失)，
+ *                    内核不支持时JSON中记为"unavailable"，其余结果不受影响
+ *             --out  JSON写入文件，默认写到标准输出；进度总是输出到标准错误
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BenchHarness.hpp"
+#include "TripleDES.H"
+#include "MD5.hpp"
+#include "MD5File.hpp"
+#include "MD5Multi.hpp"
+
+// CMake在编译时生成，其中是当前的git版本(有未提交的修改时带"-dirty")
+#ifdef BENCH_HAS_REVISION_HEADER
+#include "BenchRevision.h"
+#endif
+#ifndef BENCH_REVISION
+#define BENCH_REVISION "unknown"
+#endif
+#ifndef BENCH_BUILD_TYPE
+#define BENCH_BUILD_TYPE "unknown"
+#endif
+
+namespace fs = std::filesystem;
+
+// 内存中数据的长度
+static const size_t SIZES[] = { 64, 1 << 10, 16 << 10, 256 << 10, 1 << 20 };
+// 文件的长度
+static const size_t FILE_SIZES[] = { 64 << 10, 1 << 20, 16 << 20 };
+// 秘钥编排测试的秘钥个数
+static const size_t KEY_COUNTS[] = { 1, 256, 65536 };
+
+// xorshift，生成测试数据
+static void fill(uint8_t* p, size_t n, uint64_t seed) {
+    uint64_t x = seed | 1;
+    for (size_t i = 0; i < n; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        p[i] = (uint8_t)x;
+    }
+}
+
+static std::string sizeName(size_t n) {
+    char buf[32];
+    if (n >= (1 << 20) && n % (1 << 20) == 0) snprintf(buf, sizeof(buf), "%zuM", n >> 20);
+    else if (n >= 1024 && n % 1024 == 0) snprintf(buf, sizeof(buf), "%zuK", n >> 10);
+    else snprintf(buf, sizeof(buf), "%zu", n);
+    return buf;
+}
+
+// 测试用的临时文件，退出时删除
+class TempFiles {
+
+public:
+    TempFiles() {
+        std::error_code ec;
+        dir = fs::temp_directory_path(ec) / ("webSecurityBench." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+        fs::create_directories(dir, ec);
+    }
+
+    ~TempFiles() {
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+    }
+
+    // 新建长度为n的随机文件，返回路径
+    std::string create(const std::string& name, size_t n) {
+        std::string path = (dir / name).string();
+        std::vector<uint8_t> data(n);
+        fill(data.data(), n, n);
+        FILE* fp = fopen(path.c_str(), "wb");
+        if (!fp) return "";
+        bool ok = fwrite(data.data(), 1, n, fp) == n;
+        if (fclose(fp) != 0 || !ok) return "";
+        return path;
+    }
+
+    std::string path(const std::string& name) const {
+        return (dir / name).string();
+    }
+
+private:
+    fs::path dir;
+};
+
+static void benchDES(BenchHarness& h, TempFiles& files) {
+    const bitset<64> key(0x133457799BBCDFF1ULL);
+    const bitset<64> key2(0x0123456789ABCDEFULL);
+    DES des(key);
+    TripleDES tdes(key, key2);
+
+    std::vector<uint8_t> data(SIZES[sizeof(SIZES) / sizeof(SIZES[0]) - 1]);
+    fill(data.data(), data.size(), 1);
+    const uint64_t* blocks = (const uint64_t*)data.data();
+    std::vector<uint64_t> out(data.size() / 8);
+
+    // 原有的bitset接口，一次一个分组
+    for (size_t size : SIZES) {
+        size_t n = size / 8;
+        h.run("des.encrypt64/" + sizeName(size), size, [&] {
+            for (size_t i = 0; i < n; i++) out[i] = des.encrypt64(bitset<64>(blocks[i])).to_ullong();
+            benchKeep(out[0]);
+        });
+        h.run("des.decrypt64/" + sizeName(size), size, [&] {
+            for (size_t i = 0; i < n; i++) out[i] = des.decrypt64(bitset<64>(blocks[i])).to_ullong();
+            benchKeep(out[0]);
+        });
+    }
+
+    // 批量接口(位切片)
+    for (size_t size : SIZES) {
+        size_t n = size / 8;
+        h.run("des.encryptBlocks/" + sizeName(size), size, [&] {
+            des.encryptBlocks(blocks, out.data(), n);
+            benchKeep(out[0]);
+        });
+        h.run("tdes.encryptBlocks/" + sizeName(size), size, [&] {
+            tdes.encryptBlocks(blocks, out.data(), n);
+            benchKeep(out[0]);
+        });
+    }
+
+    // 文件加密解密，包括读写文件的时间
+    for (size_t size : FILE_SIZES) {
+        std::string name = sizeName(size);
+        if (!h.enabled("des.encryptFile/" + name) && !h.enabled("des.decryptFile/" + name)) continue;
+        std::string plain = files.create("des.plain." + name, size);
+        std::string cipher = files.path("des.cipher." + name);
+        std::string result = files.path("des.result." + name);
+        if (plain.empty()) {
+            fprintf(stderr, "bench: cannot create temporary file for des.encryptFile/%s\n", name.c_str());
+            continue;
+        }
+        des.encryptFile(plain.c_str(), cipher.c_str());
+        h.run("des.encryptFile/" + name, size, [&] {
+            des.encryptFile(plain.c_str(), cipher.c_str());
+        });
+        h.run("des.decryptFile/" + name, size, [&] {
+            des.decryptFile(cipher.c_str(), result.c_str());
+        });
+    }
+
+    // 秘钥编排，每个秘钥按8字节计
+    std::vector<uint64_t> rawKeys(KEY_COUNTS[sizeof(KEY_COUNTS) / sizeof(KEY_COUNTS[0]) - 1]);
+    fill((uint8_t*)rawKeys.data(), rawKeys.size() * 8, 2);
+    std::vector<DESKeySchedule> schedules(rawKeys.size());
+    for (size_t count : KEY_COUNTS) {
+        h.run("des.keysetup.schedule/" + std::to_string(count), count * 8, [&] {
+            for (size_t i = 0; i < count; i++) schedules[i] = DESKeySchedule(rawKeys[i]);
+            benchKeep(schedules[0]);
+        });
+        h.run("des.keysetup.bitset/" + std::to_string(count), count * 8, [&] {
+            for (size_t i = 0; i < count; i++) {
+                DES d{bitset<64>(rawKeys[i])};
+                benchKeep(d);
+            }
+        });
+    }
+}
+
+static void benchMD5(BenchHarness& h, TempFiles& files) {
+    std::vector<uint8_t> data(SIZES[sizeof(SIZES) / sizeof(SIZES[0]) - 1]);
+    fill(data.data(), data.size(), 3);
+    uint8_t digest[16];
+
+    // 原有MD5类的压缩函数，按64字节的块调用
+    MD5 md5;
+    for (size_t size : SIZES) {
+        size_t n = size / 64;
+        h.run("md5.hmd5/" + sizeName(size), size, [&] {
+            for (size_t i = 0; i < n; i++) md5.hmd5((char*)data.data() + 64 * i);
+            benchKeep(md5.A);
+        });
+    }
+
+    // 一条消息的完整摘要(包括填充)
+    for (size_t size : SIZES) {
+        h.run("md5.hash/" + sizeName(size), size, [&] {
+            MD5Context::hash(data.data(), size, digest);
+            benchKeep(digest[0]);
+        });
+    }
+
+    // 多条等长消息，共1MB
+    std::vector<MD5Span> spans;
+    std::vector<uint8_t> digests;
+    for (size_t size : SIZES) {
+        size_t n = data.size() / size;
+        spans.resize(n);
+        digests.resize(n * 16);
+        for (size_t i = 0; i < n; i++) {
+            spans[i].data = data.data() + i * size;
+            spans[i].len = size;
+        }
+        h.run("md5.multi/" + sizeName(size), n * size, [&] {
+            MD5Multi::hash(spans.data(), n, (uint8_t(*)[16])digests.data());
+            benchKeep(digests[0]);
+        });
+    }
+
+    // 整个文件的摘要
+    for (size_t size : FILE_SIZES) {
+        std::string name = sizeName(size);
+        if (!h.enabled("md5.file/" + name) && !h.enabled("md5.encrypt/" + name)) continue;
+        std::string path = files.create("md5." + name, size);
+        if (path.empty()) {
+            fprintf(stderr, "bench: cannot create temporary file for md5.file/%s\n", name.c_str());
+            continue;
+        }
+        h.run("md5.file/" + name, size, [&] {
+            uint64_t bytes;
+            MD5File::hash(path.c_str(), digest, bytes);
+            benchKeep(digest[0]);
+        });
+        h.run("md5.encrypt/" + name, size, [&] {
+            benchKeep(md5.encrypt(path.c_str()));
+        });
+    }
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s [--filter name] [--min-time seconds] [--repeats n] [--perf] [--out file]\n", name);
+}
+
+int main(int argc, char* argv[]) {
+    std::string filter, outName;
+    double minTime = 0.2;
+    int repeats = 3;
+    bool perf = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--perf") perf = true;
+        else if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if (arg == "--min-time" && i + 1 < argc) minTime = atof(argv[++i]);
+        else if (arg == "--repeats" && i + 1 < argc) repeats = atoi(argv[++i]);
+        else if (arg == "--out" && i + 1 < argc) outName = argv[++i];
+        else {
+            usage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 2;
+        }
+    }
+    if (minTime <= 0 || repeats < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    BenchHarness h(minTime, repeats, filter, perf);
+    if (perf && !h.perfAvailable())
+        fprintf(stderr, "bench: perf_event counters unavailable, reporting time and TSC cycles only\n");
+
+    TempFiles files;
+    benchDES(h, files);
+    benchMD5(h, files);
+
+    std::vector<std::pair<std::string, std::string> > extra;
+    extra.push_back(std::make_pair("revision", BenchHarness::quote(BENCH_REVISION)));
+#ifdef __VERSION__
+    extra.push_back(std::make_pair("compiler", BenchHarness::quote(__VERSION__)));
+#endif
+    extra.push_back(std::make_pair("build_type", BenchHarness::quote(BENCH_BUILD_TYPE)));
+    extra.push_back(std::make_pair("hardware_threads", std::to_string(std::thread::hardware_concurrency())));
+    extra.push_back(std::make_pair("des_bitslice_lanes", std::to_string(DESBitslice::lanes())));
+    extra.push_back(std::make_pair("md5_multi_lanes", std::to_string(MD5Multi::lanes())));
+
+    FILE* out = stdout;
+    if (!outName.empty() && !(out = fopen(outName.c_str(), "w"))) {
+        perror(outName.c_str());
+        return 1;
+    }
+    h.writeJson(out, extra);
+    if (out != stdout && fclose(out) != 0) {
+        perror(outName.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,22 @@
+# 在每次编译时运行(见CMakeLists.txt中的bench_revision)，把当前的git版本写进BenchRevision.h
+# 工作区有未提交的修改时版本号后加"-dirty"；内容没有变化时不改写文件，避免重新编译
+set(REVISION "unknown")
+if(GIT_EXECUTABLE)
+    execute_process(COMMAND ${GIT_EXECUTABLE} describe --always --dirty=-dirty --abbrev=7 --exclude=*
+                    WORKING_DIRECTORY ${SOURCE_DIR}
+                    OUTPUT_VARIABLE GIT_REVISION
+                    OUTPUT_STRIP_TRAILING_WHITESPACE
+                    ERROR_QUIET
+                    RESULT_VARIABLE GIT_RESULT)
+    if(GIT_RESULT EQUAL 0 AND GIT_REVISION)
+        set(REVISION ${GIT_REVISION})
+    endif()
+endif()
+
+set(CONTENT "#define BENCH_REVISION \"${REVISION}\"\n")
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} OLD_CONTENT)
+endif()
+if(NOT "${CONTENT}" STREQUAL "${OLD_CONTENT}")
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()